@@ -1,5 +1,12 @@
 #pragma once
+#include "frame_stats.h"
 #include "imgui.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
 #include <string>
 
 struct AppWindowConfig
@@ -15,8 +22,68 @@ struct AppWindowConfig
 struct AppRenderingConfig
 {
     ImVec4 bg_color = {.3f, .4f, .5f, 1.f};
+
+    // when enabled, the main loop blocks until input arrives or a redraw is requested instead of
+    // redrawing at full vsync rate
+    bool on_demand = false;
+
+    // draw per-phase frame timings on top of the application
+    bool show_frame_stats = false;
+
+    // build the next frame while the previous one is rendered on a separate thread, read once
+    // after Application::Initialize()
+    // NOTE only supported by the GLFW backend
+    bool pipelined = false;
+
+    // skip submission and present when the draw data is identical to the last presented frame
+    // NOTE only supported by the GLFW backend
+    bool skip_identical_frames = false;
+
+    // redraw only the regions that changed since the previous frame into a framebuffer that is
+    // kept across frames
+    // NOTE only supported by the GLFW backend
+    bool partial_redraw = false;
+
+    // directory for the font atlas cache, read once after Application::Initialize()
+    // The built atlas is stored there and loaded back on later launches with the same fonts, sizes
+    // and glyph ranges, instead of rasterizing them again. Empty disables the cache.
+    std::string font_cache_dir;
+
+    // directory for the renderer's linked shader program, read once after
+    // Application::Initialize(), loaded back on later launches with the same driver instead of
+    // compiling the shaders again. Empty disables the cache.
+    // NOTE only supported by the OpenGL backends, and drivers providing GL_ARB_get_program_binary
+    std::string program_cache_dir;
+
+    // print the time spent in each startup stage to stderr once the first frame is presented
+    bool trace_startup = false;
+
+    // resolve only the OpenGL functions the renderer uses, each on its first call, instead of all
+    // of them at startup; read before Application::Initialize(), so set it in the constructor
+    // NOTE only supported by the OpenGL backends, the application must not call OpenGL directly
+    bool lazy_gl_loading = false;
+};
+
+// only used by the HEADLESS_GL and SOFTWARE backends, which render into an offscreen framebuffer
+struct AppHeadlessConfig
+{
+    int frame_count = 600;
+
+    // fixed time step fed to imgui, so that runs are reproducible
+    double delta_time = 1. / 60.;
+
+    // sweep the mouse cursor across the framebuffer and click periodically
+    bool synthetic_input = true;
+
+    // if set, called after each frame with the RGBA8 pixels, top row first, rows are
+    // `row_pitch` bytes apart
+    std::function<void(const void* pixels, int width, int height, int row_pitch)> on_frame;
 };
 
+// implemented by the backend, wakes up the main loop if it is blocked waiting for events
+// NOTE this is safe to call from any thread
+void WakeMainLoop();
+
 class Application
 {
 public:
@@ -35,6 +102,192 @@ public:
         render_.bg_color = color;
     }
 
+    void SetOnDemandRendering(bool enable)
+    {
+        render_.on_demand = enable;
+    }
+
+    void SetShowFrameStats(bool show)
+    {
+        render_.show_frame_stats = show;
+    }
+
+    void SetPipelinedRendering(bool enable)
+    {
+        render_.pipelined = enable;
+    }
+
+    void SetSkipIdenticalFrames(bool enable)
+    {
+        render_.skip_identical_frames = enable;
+    }
+
+    void SetPartialRedraw(bool enable)
+    {
+        render_.partial_redraw = enable;
+    }
+
+    void SetFontCacheDirectory(const std::string& dir)
+    {
+        render_.font_cache_dir = dir;
+    }
+
+    void SetProgramCacheDirectory(const std::string& dir)
+    {
+        render_.program_cache_dir = dir;
+    }
+
+    void SetTraceStartup(bool enable)
+    {
+        render_.trace_startup = enable;
+    }
+
+    void SetLazyGlLoading(bool enable)
+    {
+        render_.lazy_gl_loading = enable;
+    }
+
+    const auto& HeadlessConfig() const
+    {
+        return headless_;
+    }
+
+    void SetHeadlessConfig(const AppHeadlessConfig& config)
+    {
+        headless_ = config;
+    }
+
+    // schedule another frame in on-demand mode, e.g. when background data has changed
+    // NOTE this is safe to call from any thread
+    void RequestRedraw()
+    {
+        redraw_requested_.store(true, std::memory_order_release);
+        WakeMainLoop();
+    }
+
+    // schedule a frame after `seconds` in on-demand mode, e.g. for the next step of an animation
+    // NOTE this is safe to call from any thread, the earliest pending request wins
+    void RequestRedrawAfter(double seconds)
+    {
+        auto delay    = std::chrono::duration<double>(seconds);
+        auto deadline = (Clock::now() + std::chrono::duration_cast<Clock::duration>(delay))
+                            .time_since_epoch()
+                            .count();
+
+        auto current = redraw_deadline_.load(std::memory_order_relaxed);
+        while (deadline < current &&
+               !redraw_deadline_.compare_exchange_weak(current, deadline, std::memory_order_release,
+                                                       std::memory_order_relaxed))
+        {
+        }
+
+        WakeMainLoop();
+    }
+
+    // a snapshot of the counters
+    // NOTE this is safe to call from any thread
+    AppFrameCounters FrameCounters() const
+    {
+        AppFrameCounters counters;
+        counters.rendered_frames  = rendered_frames_.load(std::memory_order_relaxed);
+        counters.skipped_frames   = skipped_frames_.load(std::memory_order_relaxed);
+        counters.identical_frames = identical_frames_.load(std::memory_order_relaxed);
+        return counters;
+    }
+
+    const auto& FrameStats() const
+    {
+        return stats_;
+    }
+
+    const auto& StartupStats() const
+    {
+        return startup_;
+    }
+
+    // used by the backend to drive the on-demand main loop
+    //
+
+    // consume pending redraw requests, returns true if a frame should be drawn now
+    bool ConsumeRedrawRequest()
+    {
+        bool requested = redraw_requested_.exchange(false, std::memory_order_acquire);
+
+        auto now      = Clock::now().time_since_epoch().count();
+        auto deadline = redraw_deadline_.load(std::memory_order_acquire);
+        if (deadline <= now &&
+            redraw_deadline_.compare_exchange_strong(deadline, kNoDeadline,
+                                                     std::memory_order_acq_rel))
+        {
+            requested = true;
+        }
+
+        return requested;
+    }
+
+    // seconds until the next scheduled redraw, or a negative value if none is scheduled
+    double SecondsUntilRedraw() const
+    {
+        auto deadline = redraw_deadline_.load(std::memory_order_acquire);
+        if (deadline == kNoDeadline)
+        {
+            return -1.;
+        }
+
+        auto remaining = Clock::duration{deadline} - Clock::now().time_since_epoch();
+        return std::max(0., std::chrono::duration<double>(remaining).count());
+    }
+
+    void RecordRenderedFrame()
+    {
+        rendered_frames_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void RecordSkippedFrames(uint64_t num_vsyncs)
+    {
+        skipped_frames_.fetch_add(num_vsyncs, std::memory_order_relaxed);
+    }
+
+    void RecordIdenticalFrame()
+    {
+        identical_frames_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void RecordFrameTiming(const FrameTimer& timer)
+    {
+        stats_.Record(timer.PhaseTimes());
+    }
+
+    void RecordFontAtlas(bool cached)
+    {
+        startup_.font_atlas_cached = cached;
+    }
+
+    void RecordProgram(bool cached)
+    {
+        startup_.program_cached = cached;
+    }
+
+    void RecordStartup(const StartupTimer& timer)
+    {
+        startup_.stage_ms = timer.StageTimes();
+    }
+
 private:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr Clock::rep kNoDeadline = std::numeric_limits<Clock::rep>::max();
+
     AppRenderingConfig render_;
+    AppHeadlessConfig headless_;
+    AppFrameStats stats_;
+    AppStartupStats startup_;
+
+    // the AppFrameCounters, atomic as they may be read while the backend updates them
+    std::atomic<uint64_t> rendered_frames_{0};
+    std::atomic<uint64_t> skipped_frames_{0};
+    std::atomic<uint64_t> identical_frames_{0};
+
+    std::atomic<bool> redraw_requested_{false};
+    std::atomic<Clock::rep> redraw_deadline_{kNoDeadline};
 };
@@ -0,0 +1,31 @@
+#pragma once
+#include "imgui.h"
+#include <cstdint>
+
+struct DynamicFontStats
+{
+    // glyphs in the ranges of dynamic fonts, and those of them that are rasterized right now
+    int glyphs          = 0;
+    int resident_glyphs = 0;
+
+    int texture_width  = 0;
+    int texture_height = 0;
+
+    uint64_t rasterized = 0;
+    uint64_t evictions  = 0;
+};
+
+// add a font to the shared atlas, like ImFontAtlas::AddFontFromFileTTF(), whose glyphs are only
+// rasterized the first time they are drawn, e.g. for CJK ranges of which a screen uses a tiny part
+//
+// Only printable ASCII is built up front, or nothing when merging. A glyph drawn for the first
+// time is blank in that frame, it is rasterized after ImGui::Render() and another frame is
+// requested. Glyphs that were not drawn for a while are evicted once the font texture is full.
+// `glyph_ranges` must stay valid as long as the atlas, as for the regular functions.
+//
+// NOTE only the GL backends rasterize on demand, the others build the full ranges up front
+ImFont* AddDynamicFontFromFileTTF(const char* filename, float size_pixels,
+                                  const ImFontConfig* font_cfg = nullptr,
+                                  const ImWchar* glyph_ranges  = nullptr);
+
+DynamicFontStats GetDynamicFontStats();
@@ -0,0 +1,331 @@
+#pragma once
+#include "imgui.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+enum class FramePhase
+{
+    Events,   // polling platform events
+    NewFrame, // backend and imgui NewFrame
+    Update,   // Application::Update
+    Render,   // ImGui::Render
+    Submit,   // renderer backend draw calls
+    Present,  // swapping buffers, including the vsync wait
+    Count
+};
+
+inline const char* FramePhaseName(FramePhase phase)
+{
+    switch (phase)
+    {
+    case FramePhase::Events:
+        return "Events";
+    case FramePhase::NewFrame:
+        return "NewFrame";
+    case FramePhase::Update:
+        return "Update";
+    case FramePhase::Render:
+        return "Render";
+    case FramePhase::Submit:
+        return "Submit";
+    case FramePhase::Present:
+        return "Present";
+    default:
+        return "Total";
+    }
+}
+
+struct AppFrameCounters
+{
+    uint64_t rendered_frames = 0;
+
+    // vsync intervals that were not drawn because the on-demand loop was idle
+    uint64_t skipped_frames = 0;
+
+    // frames that were built but not presented, because they matched the last presented one
+    uint64_t identical_frames = 0;
+};
+
+enum class StartupStage
+{
+    Platform,   // glfwInit, or opening the display
+    Window,     // creating the window and its graphics context
+    GlLoader,   // resolving the OpenGL entry points
+    Context,    // imgui context and backend bindings
+    AppInit,    // Application::Initialize
+    FontAtlas,  // building the font atlas, or restoring it from the on-disk cache
+    Renderer,   // creating the renderer's shaders and uploading the font atlas
+    FirstFrame, // drawing the first frame up to its present
+    Count
+};
+
+inline const char* StartupStageName(StartupStage stage)
+{
+    switch (stage)
+    {
+    case StartupStage::Platform:
+        return "Platform";
+    case StartupStage::Window:
+        return "Window";
+    case StartupStage::GlLoader:
+        return "GlLoader";
+    case StartupStage::Context:
+        return "Context";
+    case StartupStage::AppInit:
+        return "AppInit";
+    case StartupStage::FontAtlas:
+        return "FontAtlas";
+    case StartupStage::Renderer:
+        return "Renderer";
+    case StartupStage::FirstFrame:
+        return "FirstFrame";
+    default:
+        return "Total";
+    }
+}
+
+struct AppStartupStats
+{
+    static constexpr int kStageCount = static_cast<int>(StartupStage::Count);
+
+    // time spent in each stage up to the first frame, in milliseconds, stages a backend does not
+    // have are left at zero
+    std::array<float, kStageCount> stage_ms{};
+
+    // whether the font atlas and the renderer's program were restored from on-disk caches
+    bool font_atlas_cached = false;
+    bool program_cached    = false;
+
+    float StageMs(StartupStage stage) const
+    {
+        return stage_ms[static_cast<int>(stage)];
+    }
+
+    float TotalMs() const
+    {
+        float total = 0.f;
+        for (float ms : stage_ms)
+        {
+            total += ms;
+        }
+        return total;
+    }
+};
+
+// print the time spent in each startup stage, with every line starting with `prefix`
+inline void PrintStartupTrace(FILE* out, const char* prefix, const AppStartupStats& stats)
+{
+    fprintf(out, "%s startup %.2f ms to the first frame\n", prefix, stats.TotalMs());
+    for (int i = 0; i < AppStartupStats::kStageCount; ++i)
+    {
+        auto stage = static_cast<StartupStage>(i);
+        bool cached = (stage == StartupStage::FontAtlas && stats.font_atlas_cached) ||
+                      (stage == StartupStage::Renderer && stats.program_cached);
+        fprintf(out, "%s   %-10s %8.2f ms%s\n", prefix, StartupStageName(stage), stats.stage_ms[i],
+                cached ? " (cached)" : "");
+    }
+}
+
+struct FramePhaseSummary
+{
+    float min_ms = 0.f;
+    float avg_ms = 0.f;
+    float p99_ms = 0.f;
+};
+
+// per-phase timings of the most recent frames, in milliseconds
+//
+// The main loop is the only writer. Readers on other threads never block it, but may observe a
+// slot while it is being overwritten, which only skews that one sample.
+class AppFrameStats
+{
+public:
+    static constexpr int kCapacity   = 240;
+    static constexpr int kPhaseCount = static_cast<int>(FramePhase::Count);
+
+    // frames recorded so far, including the ones that dropped out of the buffer
+    uint64_t FrameCount() const
+    {
+        return write_index_.load(std::memory_order_acquire);
+    }
+
+    // copy the samples of a phase into `out`, oldest first, returns the number of samples
+    // NOTE FramePhase::Count yields the total frame time
+    int Samples(FramePhase phase, float (&out)[kCapacity]) const
+    {
+        uint64_t end   = FrameCount();
+        uint64_t begin = end > kCapacity ? end - kCapacity : 0;
+
+        int n = 0;
+        for (uint64_t i = begin; i < end; ++i)
+        {
+            out[n++] = slots_[i % kCapacity][static_cast<int>(phase)].load(
+                std::memory_order_relaxed);
+        }
+
+        return n;
+    }
+
+    // NOTE FramePhase::Count summarizes the total frame time
+    FramePhaseSummary Summarize(FramePhase phase) const
+    {
+        float samples[kCapacity];
+        int n = Samples(phase, samples);
+        if (n == 0)
+        {
+            return {};
+        }
+
+        FramePhaseSummary result;
+        result.min_ms = *std::min_element(samples, samples + n);
+
+        float sum = 0.f;
+        for (int i = 0; i < n; ++i)
+        {
+            sum += samples[i];
+        }
+        result.avg_ms = sum / n;
+
+        int p99 = (n * 99) / 100;
+        std::nth_element(samples, samples + p99, samples + n);
+        result.p99_ms = samples[p99];
+
+        return result;
+    }
+
+    // called by the backend once per rendered frame
+    void Record(const std::array<float, kPhaseCount>& phase_ms)
+    {
+        uint64_t index = write_index_.load(std::memory_order_relaxed);
+        auto& slot     = slots_[index % kCapacity];
+
+        float total = 0.f;
+        for (int i = 0; i < kPhaseCount; ++i)
+        {
+            slot[i].store(phase_ms[i], std::memory_order_relaxed);
+            total += phase_ms[i];
+        }
+        slot[kPhaseCount].store(total, std::memory_order_relaxed);
+
+        write_index_.store(index + 1, std::memory_order_release);
+    }
+
+private:
+    // one column per phase followed by the total
+    std::array<std::array<std::atomic<float>, kPhaseCount + 1>, kCapacity> slots_{};
+    std::atomic<uint64_t> write_index_{0};
+};
+
+// measures the phases of one frame, used by the backends
+class FrameTimer
+{
+public:
+    void Begin()
+    {
+        phase_ms_.fill(0.f);
+        last_ = Clock::now();
+    }
+
+    // attribute the time since the previous mark to `phase`
+    void Mark(FramePhase phase)
+    {
+        auto now = Clock::now();
+        phase_ms_[static_cast<int>(phase)] +=
+            std::chrono::duration<float, std::milli>(now - last_).count();
+        last_ = now;
+    }
+
+    const auto& PhaseTimes() const
+    {
+        return phase_ms_;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point last_;
+    std::array<float, AppFrameStats::kPhaseCount> phase_ms_{};
+};
+
+// measures the startup stages, used by the backends
+class StartupTimer
+{
+public:
+    StartupTimer() : last_(Clock::now())
+    {
+    }
+
+    // attribute the time since the previous mark, or since construction, to `stage`
+    void Mark(StartupStage stage)
+    {
+        auto now = Clock::now();
+        stage_ms_[static_cast<int>(stage)] +=
+            std::chrono::duration<float, std::milli>(now - last_).count();
+        last_ = now;
+    }
+
+    const auto& StageTimes() const
+    {
+        return stage_ms_;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point last_;
+    std::array<float, AppStartupStats::kStageCount> stage_ms_{};
+};
+
+namespace ImGui
+{
+    // a small window in the top-right corner with min/avg/p99 of every frame phase
+    inline void ShowFrameStatsOverlay(const AppFrameStats& stats, const AppFrameCounters& counters)
+    {
+        const float margin = 10.f;
+        ImGui::SetNextWindowPos({ImGui::GetIO().DisplaySize.x - margin, margin}, ImGuiCond_Always,
+                                {1.f, 0.f});
+        ImGui::SetNextWindowBgAlpha(0.6f);
+
+        const ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration |
+                                       ImGuiWindowFlags_AlwaysAutoResize |
+                                       ImGuiWindowFlags_NoSavedSettings |
+                                       ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav;
+        if (ImGui::Begin("##FrameStatsOverlay", nullptr, flags))
+        {
+            ImGui::Text("%-10s %7s %7s %7s", "ms", "min", "avg", "p99");
+            ImGui::Separator();
+            for (int i = 0; i <= AppFrameStats::kPhaseCount; ++i)
+            {
+                auto phase   = static_cast<FramePhase>(i);
+                auto summary = stats.Summarize(phase);
+                if (phase == FramePhase::Count)
+                {
+                    ImGui::Separator();
+                }
+                ImGui::Text("%-10s %7.2f %7.2f %7.2f", FramePhaseName(phase), summary.min_ms,
+                            summary.avg_ms, summary.p99_ms);
+            }
+
+            float totals[AppFrameStats::kCapacity];
+            int n = stats.Samples(FramePhase::Count, totals);
+            ImGui::PlotLines("##FrameTimes", totals, n, 0, nullptr, 0.f, 50.f, {0.f, 40.f});
+
+            ImGui::Text("rendered %llu, skipped %llu",
+                        static_cast<unsigned long long>(counters.rendered_frames),
+                        static_cast<unsigned long long>(counters.skipped_frames));
+
+            uint64_t built = counters.rendered_frames + counters.identical_frames;
+            if (counters.identical_frames > 0)
+            {
+                ImGui::Text("identical %llu (%.1f%%)",
+                            static_cast<unsigned long long>(counters.identical_frames),
+                            100. * counters.identical_frames / built);
+            }
+        }
+        ImGui::End();
+    }
+} // namespace ImGui
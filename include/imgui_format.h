@@ -0,0 +1,341 @@
+#pragma once
+#include "imgui.h"
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+// type safe formatting for Text(), Value(), Selectable() and TreeNode() labels, selected by
+// passing an IMGUI_FMT() string, with "{}" placeholders instead of printf conversions
+//
+//     ImGui::Text(IMGUI_FMT("{} of {} items, {:.2} ms"), shown, count, ms);
+//     ImGui::TreeNode node(entity, IMGUI_FMT("{} ({})"), name, id);
+//
+// The number of placeholders is checked against the arguments at compile time, numbers are written
+// with std::to_chars and labels go to a scratch arena that is reused every frame, instead of the
+// va_list and vsnprintf round trip of the printf style functions.
+//
+// Supported arguments are integers, floating point numbers, bool, char, strings and pointers.
+// "{:.N}" writes a floating point number with N decimals, "{{" and "}}" are literal braces.
+namespace ImGui
+{
+    namespace FormatDetail
+    {
+        // the number of placeholders, or -1 if the format string is malformed
+        template <size_t N>
+        constexpr int CountPlaceholders(const char (&str)[N])
+        {
+            int count = 0;
+            for (size_t i = 0; i < N - 1; ++i)
+            {
+                if (str[i] == '}')
+                {
+                    if (str[i + 1] != '}')
+                    {
+                        return -1;
+                    }
+                    i += 1;
+                }
+                else if (str[i] == '{')
+                {
+                    if (str[i + 1] == '{')
+                    {
+                        i += 1;
+                        continue;
+                    }
+
+                    if (str[i + 1] == ':')
+                    {
+                        if (str[i + 2] != '.' || str[i + 3] < '0' || str[i + 3] > '9')
+                        {
+                            return -1;
+                        }
+                        for (i += 3; str[i] >= '0' && str[i] <= '9'; ++i)
+                        {
+                        }
+                    }
+                    else
+                    {
+                        i += 1;
+                    }
+
+                    if (str[i] != '}')
+                    {
+                        return -1;
+                    }
+                    count += 1;
+                }
+            }
+            return count;
+        }
+    } // namespace FormatDetail
+
+    template <int Count>
+    struct FormatString
+    {
+        static_assert(Count >= 0, "malformed format string");
+
+        const char* Text;
+    };
+
+    namespace FormatDetail
+    {
+        // appends to a string in the scratch arena of the calling thread
+        // NOTE the arena is reset by the first string of a new frame, or of another imgui context
+        class Writer
+        {
+        public:
+            Writer();
+
+            void Append(const char* str, size_t length)
+            {
+                memcpy(Reserve(length), str, length);
+                pos_ += length;
+            }
+
+            void Append(std::string_view str)
+            {
+                Append(str.data(), str.size());
+            }
+
+            // room for at least `length` more characters, written by Commit()
+            char* Reserve(size_t length)
+            {
+                if (static_cast<size_t>(end_ - pos_) < length)
+                {
+                    Grow(length);
+                }
+                return pos_;
+            }
+
+            void Commit(char* end)
+            {
+                pos_ = end;
+            }
+
+            // null terminates the string, which stays valid until the arena is reset
+            std::string_view Finish();
+
+        private:
+            void Grow(size_t length);
+
+            char* begin_;
+            char* pos_;
+            char* end_;
+        };
+
+        void WriteInteger(Writer& writer, long long value);
+        void WriteInteger(Writer& writer, unsigned long long value);
+        void WriteFloat(Writer& writer, float value, int precision);
+        void WriteFloat(Writer& writer, double value, int precision);
+        void WritePointer(Writer& writer, const void* value);
+
+        template <typename T>
+        inline constexpr bool kUnsupported = false;
+
+        // `precision` is -1 unless the placeholder has one
+        template <typename T>
+        void Write(Writer& writer, const T& value, int precision)
+        {
+            if constexpr (std::is_same_v<T, bool>)
+            {
+                writer.Append(value ? "true" : "false");
+            }
+            else if constexpr (std::is_same_v<T, char>)
+            {
+                writer.Append(&value, 1);
+            }
+            else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+            {
+                WriteInteger(writer, static_cast<long long>(value));
+            }
+            else if constexpr (std::is_integral_v<T>)
+            {
+                WriteInteger(writer, static_cast<unsigned long long>(value));
+            }
+            else if constexpr (std::is_same_v<T, float>)
+            {
+                WriteFloat(writer, value, precision);
+            }
+            else if constexpr (std::is_floating_point_v<T>)
+            {
+                WriteFloat(writer, static_cast<double>(value), precision);
+            }
+            else if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, char*>)
+            {
+                writer.Append(value ? value : "(null)");
+            }
+            else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+            {
+                writer.Append(std::string_view(value));
+            }
+            else if constexpr (std::is_pointer_v<T>)
+            {
+                WritePointer(writer, value);
+            }
+            else
+            {
+                static_assert(kUnsupported<T>, "unsupported format argument type");
+            }
+        }
+
+        struct Argument
+        {
+            const void* Value;
+            void (*Write)(Writer& writer, const void* value, int precision);
+        };
+
+        template <typename T>
+        void WriteArgument(Writer& writer, const void* value, int precision)
+        {
+            Write(writer, *static_cast<const T*>(value), precision);
+        }
+
+        // `fmt` was checked by IMGUI_FMT(), `args` has one entry per placeholder
+        void Format(Writer& writer, const char* fmt, const Argument* args);
+
+        template <int Count, typename... Args>
+        std::string_view Format(const FormatString<Count>& fmt, const Args&... args)
+        {
+            static_assert(Count == sizeof...(Args), "the number of arguments does not match the "
+                                                    "number of placeholders");
+
+            // one more, as arrays may not be empty
+            const Argument arguments[] = {{&args, &WriteArgument<Args>}..., {nullptr, nullptr}};
+
+            Writer writer;
+            Format(writer, fmt.Text, arguments);
+            return writer.Finish();
+        }
+
+        // whether the current window skips its items, checked before formatting their labels, as
+        // TextV() and TreeNodeExV() do
+        bool SkipItems();
+
+        // TreeNodeEx() with the label of a string id, without formatting it once more
+        // NOTE SkipItems() must have been checked
+        bool TreeNodeEx(const char* str_id, ImGuiTreeNodeFlags flags, std::string_view label);
+        bool TreeNodeEx(const void* ptr_id, ImGuiTreeNodeFlags flags, std::string_view label);
+    } // namespace FormatDetail
+
+    // the formatted string, valid until the next frame, or until strings are formatted for another
+    // imgui context on the same thread
+    template <int Count, typename... Args>
+    const char* Format(const FormatString<Count>& fmt, const Args&... args)
+    {
+        return FormatDetail::Format(fmt, args...).data();
+    }
+
+    template <int Count, typename... Args>
+    void Text(const FormatString<Count>& fmt, const Args&... args)
+    {
+        if (FormatDetail::SkipItems())
+        {
+            return;
+        }
+
+        std::string_view text = FormatDetail::Format(fmt, args...);
+        TextUnformatted(text.data(), text.data() + text.size());
+    }
+
+    // "prefix: value", as the Value() overloads, for any supported argument type
+    template <typename T>
+    void Value(const FormatString<0>& prefix, const T& value)
+    {
+        if (FormatDetail::SkipItems())
+        {
+            return;
+        }
+
+        FormatDetail::Writer writer;
+        FormatDetail::Format(writer, prefix.Text, nullptr);
+        writer.Append(": ", 2);
+        FormatDetail::Write(writer, value, -1);
+
+        std::string_view text = writer.Finish();
+        TextUnformatted(text.data(), text.data() + text.size());
+    }
+
+    template <int Count, typename... Args>
+    bool Selectable(bool selected, const FormatString<Count>& fmt, const Args&... args)
+    {
+        if (FormatDetail::SkipItems())
+        {
+            return false;
+        }
+
+        return Selectable(FormatDetail::Format(fmt, args...).data(), selected);
+    }
+
+    template <int Count, typename... Args>
+    bool Selectable(bool* p_selected, const FormatString<Count>& fmt, const Args&... args)
+    {
+        if (FormatDetail::SkipItems())
+        {
+            return false;
+        }
+
+        return Selectable(FormatDetail::Format(fmt, args...).data(), p_selected);
+    }
+
+    // the label is also the id, as with TreeNode(const char* label)
+    template <int Count, typename... Args>
+    bool TreeNode(const FormatString<Count>& fmt, const Args&... args)
+    {
+        if (FormatDetail::SkipItems())
+        {
+            return false;
+        }
+
+        return TreeNode(FormatDetail::Format(fmt, args...).data());
+    }
+
+    template <int Count, typename... Args>
+    bool TreeNode(const char* str_id, const FormatString<Count>& fmt, const Args&... args)
+    {
+        if (FormatDetail::SkipItems())
+        {
+            return false;
+        }
+
+        return FormatDetail::TreeNodeEx(str_id, 0, FormatDetail::Format(fmt, args...));
+    }
+
+    template <int Count, typename... Args>
+    bool TreeNode(const void* ptr_id, const FormatString<Count>& fmt, const Args&... args)
+    {
+        if (FormatDetail::SkipItems())
+        {
+            return false;
+        }
+
+        return FormatDetail::TreeNodeEx(ptr_id, 0, FormatDetail::Format(fmt, args...));
+    }
+
+    template <int Count, typename... Args>
+    bool TreeNodeEx(const char* str_id, ImGuiTreeNodeFlags flags, const FormatString<Count>& fmt,
+                    const Args&... args)
+    {
+        if (FormatDetail::SkipItems())
+        {
+            return false;
+        }
+
+        return FormatDetail::TreeNodeEx(str_id, flags, FormatDetail::Format(fmt, args...));
+    }
+
+    template <int Count, typename... Args>
+    bool TreeNodeEx(const void* ptr_id, ImGuiTreeNodeFlags flags, const FormatString<Count>& fmt,
+                    const Args&... args)
+    {
+        if (FormatDetail::SkipItems())
+        {
+            return false;
+        }
+
+        return FormatDetail::TreeNodeEx(ptr_id, flags, FormatDetail::Format(fmt, args...));
+    }
+} // namespace ImGui
+
+// a FormatString of a string literal, its placeholders are counted at compile time
+#define IMGUI_FMT(str) (::ImGui::FormatString<::ImGui::FormatDetail::CountPlaceholders(str)>{str})
@@ -0,0 +1,148 @@
+#pragma once
+#include "imgui.h"
+#include <cstddef>
+
+// labels whose IDs are hashed at compile time, for PushID() and TreeNode() calls that would
+// otherwise hash the same string literals every frame
+//
+//     ImGui::TreeNode node(IMGUI_LABEL("Settings"));
+//
+// ImHashStr() is CRC32 with the top of the ID stack as seed, which is only known at runtime. The
+// CRC register is linear in its initial value and in the data, so the string's contribution is
+// computed at compile time, and the seed's one with four table lookups for any length.
+namespace ImGui
+{
+    namespace HashedLabelDetail
+    {
+        struct Crc32Table
+        {
+            ImU32 Entries[256];
+        };
+
+        // the table of ImHashStr(), polynomial 0xEDB88320
+        constexpr Crc32Table MakeCrc32Table()
+        {
+            Crc32Table table = {};
+            for (ImU32 i = 0; i < 256; ++i)
+            {
+                ImU32 crc = i;
+                for (int bit = 0; bit < 8; ++bit)
+                {
+                    crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+                }
+                table.Entries[i] = crc;
+            }
+            return table;
+        }
+
+        inline constexpr Crc32Table kCrc32 = MakeCrc32Table();
+
+        constexpr ImU32 Step(ImU32 crc, unsigned char c)
+        {
+            return (crc >> 8) ^ kCrc32.Entries[(crc & 0xFF) ^ c];
+        }
+
+        // ImHashStr() starts over from the seed at every "###", only what follows the last one
+        // is hashed
+        template <size_t N>
+        constexpr size_t HashedLength(const char (&str)[N])
+        {
+            size_t begin = 0;
+            for (size_t i = 0; i + 3 <= N - 1; ++i)
+            {
+                if (str[i] == '#' && str[i + 1] == '#' && str[i + 2] == '#')
+                {
+                    begin = i;
+                }
+            }
+            return N - 1 - begin;
+        }
+
+        // the register after `Length` zero bytes, by byte of the initial one
+        struct SeedTables
+        {
+            ImU32 Entries[4][256];
+        };
+
+        template <size_t Length>
+        constexpr SeedTables MakeSeedTables()
+        {
+            ImU32 bits[32] = {};
+            for (int bit = 0; bit < 32; ++bit)
+            {
+                ImU32 crc = 1u << bit;
+                for (size_t i = 0; i < Length; ++i)
+                {
+                    crc = Step(crc, 0);
+                }
+                bits[bit] = crc;
+            }
+
+            SeedTables tables = {};
+            for (int byte = 0; byte < 4; ++byte)
+            {
+                for (int value = 0; value < 256; ++value)
+                {
+                    ImU32 crc = 0;
+                    for (int bit = 0; bit < 8; ++bit)
+                    {
+                        crc ^= (value >> bit) & 1 ? bits[byte * 8 + bit] : 0;
+                    }
+                    tables.Entries[byte][value] = crc;
+                }
+            }
+            return tables;
+        }
+
+        // shared by all labels hashing the same number of characters
+        template <size_t Length>
+        inline constexpr SeedTables kSeedTables = MakeSeedTables<Length>();
+    } // namespace HashedLabelDetail
+
+    struct HashedLabel
+    {
+        // shown as usual, i.e. up to the first "##"
+        const char* Text;
+
+        // the register after hashing the label from zero
+        ImU32 Crc;
+        const HashedLabelDetail::SeedTables* Seed;
+
+        // the same as ImHashStr(Text, 0, seed)
+        ImGuiID GetID(ImGuiID seed) const
+        {
+            ImU32 s   = ~seed;
+            ImU32 crc = Seed->Entries[0][s & 0xFF] ^ Seed->Entries[1][(s >> 8) & 0xFF] ^
+                        Seed->Entries[2][(s >> 16) & 0xFF] ^ Seed->Entries[3][s >> 24];
+            return ~(crc ^ Crc);
+        }
+    };
+
+    namespace HashedLabelDetail
+    {
+        template <size_t Length, size_t N>
+        constexpr HashedLabel MakeHashedLabel(const char (&str)[N])
+        {
+            ImU32 crc = 0;
+            for (size_t i = N - 1 - Length; i < N - 1; ++i)
+            {
+                crc = Step(crc, static_cast<unsigned char>(str[i]));
+            }
+            return {str, crc, &kSeedTables<Length>};
+        }
+    } // namespace HashedLabelDetail
+
+    // the equivalents of GetID(), PushID(), TreeNode() and TreeNodeEx() with a string label
+    ImGuiID GetID(const HashedLabel& label);
+    void PushID(const HashedLabel& label);
+    bool TreeNode(const HashedLabel& label);
+    bool TreeNodeEx(const HashedLabel& label, ImGuiTreeNodeFlags flags = 0);
+} // namespace ImGui
+
+// a HashedLabel of a string literal, evaluated at compile time
+#define IMGUI_LABEL(str)                                                                           \
+    ([]() -> const ::ImGui::HashedLabel& {                                                         \
+        static constexpr ::ImGui::HashedLabel label = ::ImGui::HashedLabelDetail::MakeHashedLabel< \
+            ::ImGui::HashedLabelDetail::HashedLength(str)>(str);                                   \
+        return label;                                                                              \
+    }())
@@ -2,6 +2,8 @@
 
 #pragma once
 #include "imgui.h"
+#include "imgui_format.h"
+#include "imgui_hashed_label.h"
 
 namespace ImGui
 {
@@ -205,6 +207,10 @@ namespace ImGui
         {
             ImGui::PushID(int_id);
         }
+        ID(const HashedLabel& label)
+        {
+            ImGui::PushID(label);
+        }
         ~ID()
         {
             ImGui::PopID();
@@ -243,6 +249,10 @@ namespace ImGui
         {
             IsOpen = ImGui::TreeNode(label);
         }
+        TreeNode(const HashedLabel& label)
+        {
+            IsOpen = ImGui::TreeNode(label);
+        }
         TreeNode(const char* str_id, const char* fmt, ...) IM_FMTARGS(3)
         {
             va_list ap;
@@ -257,6 +267,21 @@ namespace ImGui
             IsOpen = ImGui::TreeNodeV(ptr_id, fmt, ap);
             va_end(ap);
         }
+        template <int Count, typename... Args>
+        TreeNode(const FormatString<Count>& fmt, const Args&... args)
+        {
+            IsOpen = ImGui::TreeNode(fmt, args...);
+        }
+        template <int Count, typename... Args>
+        TreeNode(const char* str_id, const FormatString<Count>& fmt, const Args&... args)
+        {
+            IsOpen = ImGui::TreeNode(str_id, fmt, args...);
+        }
+        template <int Count, typename... Args>
+        TreeNode(const void* ptr_id, const FormatString<Count>& fmt, const Args&... args)
+        {
+            IsOpen = ImGui::TreeNode(ptr_id, fmt, args...);
+        }
         ~TreeNode()
         {
             if (IsOpen)
@@ -306,6 +331,11 @@ namespace ImGui
             IM_ASSERT(!(flags & ImGuiTreeNodeFlags_NoTreePushOnOpen));
             IsOpen = ImGui::TreeNodeEx(label, flags);
         }
+        TreeNodeEx(const HashedLabel& label, ImGuiTreeNodeFlags flags = 0)
+        {
+            IM_ASSERT(!(flags & ImGuiTreeNodeFlags_NoTreePushOnOpen));
+            IsOpen = ImGui::TreeNodeEx(label, flags);
+        }
         TreeNodeEx(const char* str_id, ImGuiTreeNodeFlags flags, const char* fmt, ...) IM_FMTARGS(4)
         {
             va_list ap;
@@ -322,6 +352,20 @@ namespace ImGui
             IsOpen = ImGui::TreeNodeExV(ptr_id, flags, fmt, ap);
             va_end(ap);
         }
+        template <int Count, typename... Args>
+        TreeNodeEx(const char* str_id, ImGuiTreeNodeFlags flags, const FormatString<Count>& fmt,
+                   const Args&... args)
+        {
+            IM_ASSERT(!(flags & ImGuiTreeNodeFlags_NoTreePushOnOpen));
+            IsOpen = ImGui::TreeNodeEx(str_id, flags, fmt, args...);
+        }
+        template <int Count, typename... Args>
+        TreeNodeEx(const void* ptr_id, ImGuiTreeNodeFlags flags, const FormatString<Count>& fmt,
+                   const Args&... args)
+        {
+            IM_ASSERT(!(flags & ImGuiTreeNodeFlags_NoTreePushOnOpen));
+            IsOpen = ImGui::TreeNodeEx(ptr_id, flags, fmt, args...);
+        }
         ~TreeNodeEx()
         {
             if (IsOpen)
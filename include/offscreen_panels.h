@@ -0,0 +1,77 @@
+#pragma once
+#include "imgui.h"
+#include "platform.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+class WorkerPool;
+
+struct OffscreenPanelsConfig
+{
+    // threads building panels, including the one calling Update(), <= 0 uses all hardware threads
+    // NOTE panels are only built concurrently if QuickImGui was configured with
+    // QUICK_IMGUI_THREADED_PANELS, otherwise this is always 1
+    int num_threads = 0;
+
+    // the panels are rendered over it, opaque so that their textures need no blending
+    ImVec4 clear_color = {.06f, .06f, .06f, 1.f};
+};
+
+// imgui panels, e.g. dashboard tiles, built concurrently on worker threads and rendered into
+// textures that the main UI draws as images
+//
+// Every panel has an imgui context of its own that shares the font atlas of the main one and
+// copies its style when the panel is added. The current context is per thread, so `draw` uses the
+// ImGui API as usual. Panels get no input, they are rebuilt from scratch on every Update().
+//
+// NOTE `draw` functions run concurrently, they must not touch the main context, allocate textures
+// or modify the font atlas. The DX11 backend cannot render into textures, its panels stay blank.
+class OffscreenPanels
+{
+public:
+    explicit OffscreenPanels(OffscreenPanelsConfig config = {});
+    ~OffscreenPanels();
+
+    // a panel of `width` x `height` pixels whose frame `draw` builds, e.g. as a window filling it
+    // returns its id, or -1 if its texture cannot be allocated
+    int Add(int width, int height, std::function<void()> draw);
+    void Remove(int id);
+
+    // build the frames of all panels on the worker threads, then render them into their textures
+    // Call on the main thread once per frame, e.g. in Application::Update(), before the panels are
+    // drawn. Returns true if glyphs were rasterized for them, i.e. in on-demand mode another frame
+    // should be requested.
+    bool Update();
+
+    // draw the panel as an image of its own size
+    void Draw(int id) const;
+
+    // nullptr if there is no such panel
+    ImTextureID Texture(int id) const;
+
+    // time the last Update() spent building the panels, and rendering them
+    double BuildMs() const
+    {
+        return build_ms_;
+    }
+    double RenderMs() const
+    {
+        return render_ms_;
+    }
+
+private:
+    struct Panel;
+
+    Panel* Find(int id) const;
+    static void Build(Panel& panel, float delta_time);
+
+    OffscreenPanelsConfig config_;
+    std::unique_ptr<WorkerPool> workers_;
+
+    std::vector<std::unique_ptr<Panel>> panels_;
+    int next_id_ = 0;
+
+    double build_ms_  = 0.;
+    double render_ms_ = 0.;
+};
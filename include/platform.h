@@ -1,6 +1,8 @@
 #pragma once
 #include "application.h"
 #include "imgui.h"
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <tuple>
 #include <memory>
@@ -8,6 +10,8 @@
 class PlatformWindow
 {
 public:
+    virtual ~PlatformWindow() = default;
+
     virtual void SetTitle(const std::string& title) = 0;
 
     virtual void SetSize(int width, int height) = 0;
@@ -15,8 +19,40 @@ public:
 
     virtual void SetPosition(int x, int y)    = 0;
     virtual std::pair<int, int> GetPosition() = 0;
+
+    // false once the user closed the window, see OpenWindow()
+    virtual bool IsOpen()
+    {
+        return true;
+    }
+};
+
+enum class TextureFormat
+{
+    Rgba8,
+    Bgra8,
+    R8,     // shown as grayscale
+    Rg8,    // shown as grayscale with alpha in G
+    R16F,   // shown as grayscale
+    R32F,   // shown as grayscale
+    Rgb565, // red in the highest bits
 };
 
+inline int BytesPerPixel(TextureFormat format)
+{
+    switch (format)
+    {
+    case TextureFormat::R8:
+        return 1;
+    case TextureFormat::Rg8:
+    case TextureFormat::R16F:
+    case TextureFormat::Rgb565:
+        return 2;
+    default:
+        return 4;
+    }
+}
+
 class PlatformTexture
 {
 public:
@@ -26,10 +62,45 @@ public:
     virtual ~PlatformTexture() = default;
 
     // size of buffer is width_ * height_ * 4, i.e. RGBA
+    // NOTE only for Rgba8 textures, use UpdatePixels() for other formats
     virtual void UpdateRgba(const void* p) = 0;
 
-    // size of buffer is width_ * height_ * 4, i.e. RGBA
-    // virtual void Update(std::function<void(void* p, int row_pitch)> f) = 0;
+    // size of buffer is width_ * height_ * BytesPerPixel(format_), in the texture's format
+    void UpdatePixels(const void* p)
+    {
+        UpdateRegion(0, 0, width_, height_, p, width_ * BytesPerPixel(format_));
+    }
+
+    // update the rectangle at (x, y) of size (width, height) from pixels in the texture's format,
+    // rows of the source buffer are `row_stride` bytes apart
+    virtual void UpdateRegion(int x, int y, int width, int height, const void* p,
+                              int row_stride) = 0;
+
+    // `f` writes pixels in the texture's format straight into upload memory, rows are `row_pitch`
+    // bytes apart
+    // NOTE the memory is released even if `f` throws, the exception is then rethrown
+    virtual void Update(std::function<void(void* p, int row_pitch)> f) = 0;
+
+    // true once the GPU has received the data of all previous updates. Updates may complete
+    // asynchronously, but the source buffer can always be reused as soon as they return.
+    virtual bool IsUploadComplete()
+    {
+        return true;
+    }
+
+    // allow the storage of this texture to be released while texture memory is over budget and
+    // it is not drawn, see SetTextureMemoryBudget(). Id() stays valid. The storage comes back the
+    // next time draw data references the texture or it is updated, and `restore` is then called
+    // to upload the pixels again.
+    // NOTE the DX11 backend only accounts textures and never evicts them
+    void SetEvictable(std::function<void(PlatformTexture& texture)> restore)
+    {
+        restore_ = std::move(restore);
+    }
+    bool IsEvicted() const
+    {
+        return evicted_;
+    }
 
     ImTextureID Id() const
     {
@@ -43,22 +114,114 @@ public:
     {
         return height_;
     }
+    TextureFormat Format() const
+    {
+        return format_;
+    }
 
 protected:
+    friend class TextureMemory;
+
+    // release the storage while keeping Id() valid, returns false if the backend cannot
+    virtual bool EvictStorage()
+    {
+        return false;
+    }
+
+    // reallocate the storage released by EvictStorage(), the contents are undefined
+    virtual void RestoreStorage()
+    {
+    }
+
     void Clear()
     {
-        id_     = nullptr;
-        width_  = 0;
-        height_ = 0;
+        id_      = nullptr;
+        width_   = 0;
+        height_  = 0;
+        format_  = TextureFormat::Rgba8;
+        restore_ = nullptr;
+        evicted_ = false;
     }
 
-    ImTextureID id_ = nullptr;
-    int width_      = 0;
-    int height_     = 0;
+    ImTextureID id_       = nullptr;
+    int width_            = 0;
+    int height_           = 0;
+    TextureFormat format_ = TextureFormat::Rgba8;
+
+    std::function<void(PlatformTexture&)> restore_;
+    bool evicted_ = false;
+};
+
+struct PlatformTextureStats
+{
+    uint64_t uploads = 0;
+
+    // uploads that were staged in a pixel buffer instead of being copied synchronously
+    uint64_t async_uploads = 0;
+
+    // async uploads issued while the previous upload to the same texture was still in flight,
+    // which a synchronous upload would have had to wait for
+    uint64_t stalls_avoided = 0;
+
+    // AllocateTexture calls that reused a released texture of the same size and format, and
+    // those that had to create a new one
+    uint64_t pool_hits   = 0;
+    uint64_t pool_misses = 0;
+
+    // device memory held by released textures that wait for reuse
+    uint64_t pooled_bytes = 0;
+};
+
+struct TextureMemoryStats
+{
+    // storage of live textures, excluding evicted ones and the texture pool
+    uint64_t current_bytes = 0;
+    uint64_t peak_bytes    = 0;
+
+    // 0 if unlimited
+    uint64_t budget_bytes = 0;
+
+    uint64_t evictions    = 0;
+    uint64_t restorations = 0;
 };
 
+// the window whose frame is being built, i.e. the one of RunApplication(), or one opened by
+// OpenWindow() while its `draw` function runs
 PlatformWindow& GetCurrentWindow();
 
-std::unique_ptr<PlatformTexture> AllocateTexture(int width, int height);
+// open another top-level window with an imgui context of its own, which shares the font atlas and
+// all textures with the main window, so that a texture uploaded once can be drawn in any of them.
+// `draw` builds the window's contents once per frame, after Application::Update(), with its
+// context current.
+//
+// Closing the window only hides it, see PlatformWindow::IsOpen(), it is destroyed along with the
+// returned object, which must not happen within its own `draw` function.
+// NOTE only the GLFW backend supports this, the others return nullptr, as does calling it before
+// Application::Initialize()
+std::unique_ptr<PlatformWindow> OpenWindow(const AppWindowConfig& config,
+                                           std::function<void()> draw);
+
+const PlatformTextureStats& GetTextureStats();
+
+// NOTE the contents of a new texture are undefined, it may be a recycled one
+std::unique_ptr<PlatformTexture> AllocateTexture(int width, int height,
+                                                 TextureFormat format = TextureFormat::Rgba8);
+
+// render `draw_data` into `texture`, an Rgba8 texture the size of the draw data's framebuffer,
+// over `clear_color`, e.g. to draw an imgui frame built on another context as an image
+// returns false if the backend cannot render into textures
+// NOTE not supported by the DX11 backend
+bool RenderToTexture(PlatformTexture& texture, ImDrawData* draw_data, ImVec4 clear_color);
+
+// released textures are kept for reuse by AllocateTexture up to this much device memory, 0
+// disables recycling, the default is 64MB
+// NOTE the software backend does not recycle textures
+void SetTexturePoolCapacity(size_t bytes);
+
+const TextureMemoryStats& GetTextureMemoryStats();
+
+// evictable textures that were not drawn in the current frame are evicted, least recently drawn
+// first, while live textures use more than this, 0 disables eviction
+void SetTextureMemoryBudget(size_t bytes);
 
 int RunApplication(Application& app, AppWindowConfig window_config = {});
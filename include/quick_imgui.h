@@ -5,4 +5,10 @@
 #include "imgui_scoped.h"
 
 #include "platform.h"
+#include "streaming_texture.h"
+#include "texture_atlas.h"
+#include "texture_loader.h"
+#include "tiled_image_view.h"
+#include "dynamic_font.h"
+#include "offscreen_panels.h"
 #include "application.h"
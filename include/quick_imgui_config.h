@@ -0,0 +1,12 @@
+// imgui configuration of QuickImGui, included by imconfig.h through IMGUI_USER_CONFIG, which
+// CMakeLists.txt defines for the library's sources with QUICK_IMGUI_THREADED_PANELS
+
+#pragma once
+
+// the current context is per thread, so that OffscreenPanels can build frames of several contexts
+// at once, see "Context creation and access" in imgui.cpp
+// NOTE every thread starts without a current context, and code outside the library must not use
+// GImGui, which it does not see redefined, but ImGui::GetCurrentContext()
+struct ImGuiContext;
+extern thread_local ImGuiContext* QuickImGuiContext;
+#define GImGui QuickImGuiContext
@@ -0,0 +1,216 @@
+#pragma once
+#include "platform.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+struct StreamingTextureStats
+{
+    uint64_t published = 0;
+    uint64_t uploaded  = 0;
+
+    // published frames that were replaced by a newer one before the UI got to upload them, and
+    // frames that could not be written because another producer held the write slot
+    uint64_t dropped = 0;
+
+    // uploaded frames that had waited longer than a whole UI frame, e.g. because the UI stalled
+    uint64_t late = 0;
+};
+
+// a texture fed by producer threads, e.g. video capture, through a triple buffer
+//
+// Producers fill the back buffer and publish it by swapping it with the middle one, the UI thread
+// swaps the middle buffer to the front when it holds a newer frame and uploads it. Neither side
+// ever waits for the other, a frame that is not picked up in time is replaced by the next one.
+//
+// NOTE one producer writes at a time, AcquireWrite() fails while another one holds the slot
+class StreamingTexture
+{
+public:
+    class WriteSlot
+    {
+    public:
+        WriteSlot() = default;
+        WriteSlot(WriteSlot&& other) noexcept : owner_(other.owner_)
+        {
+            other.owner_ = nullptr;
+        }
+        WriteSlot& operator=(WriteSlot&& other) noexcept
+        {
+            std::swap(owner_, other.owner_);
+            return *this;
+        }
+
+        // abandons the frame if it was not published
+        ~WriteSlot()
+        {
+            if (owner_ != nullptr)
+            {
+                owner_->writing_.clear(std::memory_order_release);
+            }
+        }
+
+        explicit operator bool() const
+        {
+            return owner_ != nullptr;
+        }
+
+        // pixels in the texture's format, rows are RowPitch() bytes apart
+        void* Data()
+        {
+            return owner_->buffers_[owner_->back_].pixels.data();
+        }
+        int RowPitch() const
+        {
+            return owner_->row_pitch_;
+        }
+
+    private:
+        friend class StreamingTexture;
+
+        explicit WriteSlot(StreamingTexture* owner) : owner_(owner)
+        {
+        }
+
+        StreamingTexture* owner_ = nullptr;
+    };
+
+    // must be called on the main thread, before any producer starts
+    bool Initialize(int width, int height, TextureFormat format = TextureFormat::Rgba8)
+    {
+        texture_ = AllocateTexture(width, height, format);
+        if (texture_ == nullptr)
+        {
+            return false;
+        }
+
+        row_pitch_ = width * BytesPerPixel(format);
+        for (auto& buffer : buffers_)
+        {
+            buffer.pixels.assign(static_cast<size_t>(row_pitch_) * height, 0);
+        }
+        return true;
+    }
+
+    // called on the producer's thread after every publish, e.g. to request a redraw
+    void SetPublishCallback(std::function<void()> on_publish)
+    {
+        on_publish_ = std::move(on_publish);
+    }
+
+    // any thread, returns an empty slot if another producer is writing
+    WriteSlot AcquireWrite()
+    {
+        if (writing_.test_and_set(std::memory_order_acquire))
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return {};
+        }
+
+        return WriteSlot{this};
+    }
+
+    // make the written frame the newest one, replacing a previous frame that was not uploaded
+    void Publish(WriteSlot slot)
+    {
+        IM_ASSERT(slot.owner_ == this);
+        buffers_[back_].published_at = Clock::now().time_since_epoch().count();
+
+        uint32_t previous = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel);
+        back_             = previous & kIndexMask;
+        if (previous & kFresh)
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        published_.fetch_add(1, std::memory_order_relaxed);
+
+        // release the write slot before notifying
+        slot = {};
+        if (on_publish_)
+        {
+            on_publish_();
+        }
+    }
+
+    // main thread, once per frame, uploads the newest published frame if there is one
+    // returns true if the texture changed
+    bool Update()
+    {
+        auto now      = Clock::now().time_since_epoch().count();
+        auto previous = last_update_;
+        last_update_  = now;
+
+        if ((middle_.load(std::memory_order_relaxed) & kFresh) == 0)
+        {
+            return false;
+        }
+
+        uint32_t middle = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_          = middle & kIndexMask;
+
+        const Buffer& buffer = buffers_[front_];
+        texture_->UpdateRegion(0, 0, texture_->Width(), texture_->Height(), buffer.pixels.data(),
+                               row_pitch_);
+
+        uploaded_ += 1;
+        if (previous != 0 && buffer.published_at < previous)
+        {
+            late_ += 1;
+        }
+        return true;
+    }
+
+    PlatformTexture& Texture()
+    {
+        return *texture_;
+    }
+    ImTextureID Id() const
+    {
+        return texture_->Id();
+    }
+
+    // NOTE call on the main thread, counters written by producers may lag slightly
+    StreamingTextureStats Stats() const
+    {
+        StreamingTextureStats stats;
+        stats.published = published_.load(std::memory_order_relaxed);
+        stats.uploaded  = uploaded_;
+        stats.dropped   = dropped_.load(std::memory_order_relaxed);
+        stats.late      = late_;
+        return stats;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // the middle index carries a flag for a frame that was published but not uploaded yet
+    static constexpr uint32_t kIndexMask = 0x3;
+    static constexpr uint32_t kFresh     = 0x4;
+
+    struct Buffer
+    {
+        std::vector<uint8_t> pixels;
+        Clock::rep published_at = 0;
+    };
+
+    PlatformTexture::Ptr texture_;
+    int row_pitch_ = 0;
+    Buffer buffers_[3];
+
+    // owned by the producer holding `writing_`, the shared one, and owned by the main thread
+    uint32_t back_ = 0;
+    std::atomic<uint32_t> middle_{1};
+    uint32_t front_ = 2;
+
+    std::atomic_flag writing_ = ATOMIC_FLAG_INIT;
+    std::function<void()> on_publish_;
+
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> dropped_{0};
+    uint64_t uploaded_      = 0;
+    uint64_t late_          = 0;
+    Clock::rep last_update_ = 0;
+};
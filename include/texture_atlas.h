@@ -0,0 +1,499 @@
+#pragma once
+#include "imgui.h"
+#include "platform.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+struct AtlasRegion
+{
+    ImTextureID texture = nullptr;
+    ImVec2 uv0;
+    ImVec2 uv1;
+};
+
+// packs many small images into one PlatformTexture, so that drawing them does not break imgui's
+// batching
+//
+// Images are placed with a bottom-left skyline packer, with a pixel of transparent padding so
+// that linear filtering does not bleed between neighbours. Removed images leave holes until the
+// atlas is defragmented, which repacks every live image from a CPU copy of the atlas into a new
+// texture. When an image does not fit, images that were not drawn in the current or previous
+// frame are evicted, least recently drawn first.
+//
+// NOTE handles stay valid across defragmentation, but their UVs change, so look them up every
+// frame instead of caching them
+class TextureAtlas
+{
+public:
+    using Handle = uint32_t;
+
+    static constexpr Handle kInvalidHandle = 0;
+    static constexpr int kPadding          = 1;
+
+    bool Initialize(int width, int height, TextureFormat format = TextureFormat::Rgba8)
+    {
+        texture_ = AllocateTexture(width, height, format);
+        if (texture_ == nullptr)
+        {
+            return false;
+        }
+
+        bytes_per_pixel_ = BytesPerPixel(format);
+        pixels_.assign(static_cast<size_t>(width) * height * bytes_per_pixel_, 0);
+        texture_->UpdatePixels(pixels_.data());
+
+        ResetSkyline();
+        return true;
+    }
+
+    // called with the handle of every image that is evicted to make room for a new one
+    void SetEvictionCallback(std::function<void(Handle)> on_evict)
+    {
+        on_evict_ = std::move(on_evict);
+    }
+
+    // copy an image in the atlas' format into the atlas, rows are `row_stride` bytes apart, or
+    // tightly packed if 0
+    // returns kInvalidHandle if the image does not fit, even after eviction
+    Handle Add(int width, int height, const void* p, int row_stride = 0)
+    {
+        IM_ASSERT(texture_ != nullptr && width > 0 && height > 0);
+        if (row_stride == 0)
+        {
+            row_stride = width * bytes_per_pixel_;
+        }
+
+        int padded_w = width + 2 * kPadding;
+        int padded_h = height + 2 * kPadding;
+
+        int x, y;
+        ReleaseRetired();
+        if (!Pack(padded_w, padded_h, &x, &y) && !MakeRoom(padded_w, padded_h, &x, &y))
+        {
+            return kInvalidHandle;
+        }
+
+        Handle handle = next_handle_++;
+        Entry& entry  = entries_[handle];
+        entry.x       = x + kPadding;
+        entry.y       = y + kPadding;
+        entry.width   = width;
+        entry.height  = height;
+
+        entry.last_used_frame = ImGui::GetFrameCount();
+        used_area_ += static_cast<int64_t>(padded_w) * padded_h;
+
+        ClearRect(x, y, padded_w, padded_h);
+        for (int row = 0; row < height; ++row)
+        {
+            memcpy(Pixel(entry.x, entry.y + row),
+                   static_cast<const uint8_t*>(p) + static_cast<size_t>(row) * row_stride,
+                   static_cast<size_t>(width) * bytes_per_pixel_);
+        }
+        Upload(x, y, padded_w, padded_h);
+
+        return handle;
+    }
+
+    // the space is reclaimed by the next Defragment()
+    void Remove(Handle handle)
+    {
+        auto it = entries_.find(handle);
+        if (it != entries_.end())
+        {
+            used_area_ -= PaddedArea(it->second);
+            entries_.erase(it);
+        }
+    }
+
+    bool Contains(Handle handle) const
+    {
+        return entries_.count(handle) != 0;
+    }
+
+    // UVs of an image in the shared texture, marks the image as used in this frame
+    AtlasRegion Region(Handle handle)
+    {
+        auto it = entries_.find(handle);
+        if (it == entries_.end())
+        {
+            return {};
+        }
+
+        Entry& entry          = it->second;
+        entry.last_used_frame = ImGui::GetFrameCount();
+
+        float inv_w = 1.f / texture_->Width();
+        float inv_h = 1.f / texture_->Height();
+        return {texture_->Id(),
+                {entry.x * inv_w, entry.y * inv_h},
+                {(entry.x + entry.width) * inv_w, (entry.y + entry.height) * inv_h}};
+    }
+
+    void Image(Handle handle, const ImVec2& size, const ImVec4& tint_col = {1, 1, 1, 1},
+               const ImVec4& border_col = {0, 0, 0, 0})
+    {
+        AtlasRegion region = Region(handle);
+        ImGui::Image(region.texture, size, region.uv0, region.uv1, tint_col, border_col);
+    }
+
+    // repack every live image into a new texture, reclaiming the space of removed ones
+    // NOTE the old texture is kept for a frame, the pipelined renderer may still be drawing it
+    // returns false if the new texture could not be allocated, the atlas is unchanged then
+    bool Defragment()
+    {
+        ReleaseRetired();
+
+        auto texture = AllocateTexture(texture_->Width(), texture_->Height(), texture_->Format());
+        if (texture == nullptr)
+        {
+            return false;
+        }
+
+        std::vector<std::pair<Handle, Entry*>> order;
+        order.reserve(entries_.size());
+        for (auto& [handle, entry] : entries_)
+        {
+            order.emplace_back(handle, &entry);
+        }
+
+        // tall images first packs the skyline much tighter
+        std::sort(order.begin(), order.end(), [](const auto& a, const auto& b) {
+            return a.second->height != b.second->height ? a.second->height > b.second->height
+                                                        : a.first < b.first;
+        });
+
+        std::vector<uint8_t> old_pixels(pixels_.size(), 0);
+        old_pixels.swap(pixels_);
+        ResetSkyline();
+
+        for (auto& [handle, entry] : order)
+        {
+            int x, y;
+            if (!Pack(entry->width + 2 * kPadding, entry->height + 2 * kPadding, &x, &y))
+            {
+                // only happens if the atlas was nearly full and the new order packs worse
+                used_area_ -= PaddedArea(*entry);
+                entries_.erase(handle);
+                NotifyEvicted(handle);
+                continue;
+            }
+
+            size_t row_bytes = static_cast<size_t>(entry->width) * bytes_per_pixel_;
+            for (int row = 0; row < entry->height; ++row)
+            {
+                memcpy(Pixel(x + kPadding, y + kPadding + row),
+                       &old_pixels[PixelOffset(entry->x, entry->y + row)], row_bytes);
+            }
+            entry->x = x + kPadding;
+            entry->y = y + kPadding;
+        }
+
+        texture->UpdatePixels(pixels_.data());
+        retired_.emplace_back(std::move(texture_), ImGui::GetFrameCount());
+        texture_ = std::move(texture);
+
+        defragmentations_ += 1;
+        return true;
+    }
+
+    const PlatformTexture& Texture() const
+    {
+        return *texture_;
+    }
+    ImTextureID Id() const
+    {
+        return texture_->Id();
+    }
+    int Count() const
+    {
+        return static_cast<int>(entries_.size());
+    }
+
+    // fraction of the atlas covered by live images, including their padding
+    float Occupancy() const
+    {
+        return static_cast<float>(used_area_) / (texture_->Width() * texture_->Height());
+    }
+
+    uint64_t Evictions() const
+    {
+        return evictions_;
+    }
+    uint64_t Defragmentations() const
+    {
+        return defragmentations_;
+    }
+
+private:
+    struct Entry
+    {
+        int x      = 0;
+        int y      = 0;
+        int width  = 0;
+        int height = 0;
+
+        int last_used_frame = 0;
+    };
+
+    // a horizontal segment of the skyline, everything below `y` is taken
+    struct SkylineNode
+    {
+        int x;
+        int y;
+        int width;
+    };
+
+    void ResetSkyline()
+    {
+        skyline_.assign(1, {0, 0, texture_->Width()});
+    }
+
+    // defragment and evict until a padded rectangle fits
+    bool MakeRoom(int padded_w, int padded_h, int* x, int* y)
+    {
+        int64_t atlas_area = static_cast<int64_t>(texture_->Width()) * texture_->Height();
+        int64_t needed     = static_cast<int64_t>(padded_w) * padded_h;
+        if (padded_w > texture_->Width() || padded_h > texture_->Height())
+        {
+            return false;
+        }
+
+        // least recently used first, images drawn in this frame are never evicted, neither are
+        // those of the previous frame, which the pipelined renderer may still be drawing
+        std::vector<std::pair<int, Handle>> candidates;
+        int frame = ImGui::GetFrameCount() - 1;
+        for (const auto& [handle, entry] : entries_)
+        {
+            if (entry.last_used_frame < frame)
+            {
+                candidates.emplace_back(entry.last_used_frame, handle);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        // if evicting at all, free an extra quarter of the atlas, the skyline does not pack much
+        // tighter than that and the next images should fit without repacking again
+        int64_t budget = atlas_area - needed;
+        if (used_area_ > budget)
+        {
+            budget -= atlas_area / 4;
+        }
+
+        size_t next = 0;
+        while (true)
+        {
+            // repacking only helps if there is enough free area
+            while (used_area_ > budget && next < candidates.size())
+            {
+                Evict(candidates[next++].second);
+            }
+            if (used_area_ + needed > atlas_area)
+            {
+                return false;
+            }
+
+            if (!Defragment())
+            {
+                return false;
+            }
+            if (Pack(padded_w, padded_h, x, y))
+            {
+                return true;
+            }
+
+            // the free area is too fragmented, give up some more
+            if (next == candidates.size())
+            {
+                return false;
+            }
+            budget = std::min(budget, used_area_) - atlas_area / 8;
+        }
+    }
+
+    // textures replaced before the previous frame are no longer drawn
+    void ReleaseRetired()
+    {
+        int frame = ImGui::GetFrameCount();
+        retired_.erase(std::remove_if(retired_.begin(), retired_.end(),
+                                      [frame](const auto& retired) {
+                                          return retired.second < frame - 1;
+                                      }),
+                       retired_.end());
+    }
+
+    void Evict(Handle handle)
+    {
+        auto it = entries_.find(handle);
+        if (it == entries_.end())
+        {
+            return;
+        }
+
+        used_area_ -= PaddedArea(it->second);
+        entries_.erase(it);
+        NotifyEvicted(handle);
+    }
+
+    void NotifyEvicted(Handle handle)
+    {
+        evictions_ += 1;
+        if (on_evict_)
+        {
+            on_evict_(handle);
+        }
+    }
+
+    // bottom-left skyline placement, picks the position with the lowest top edge, then the
+    // narrowest segment
+    bool Pack(int width, int height, int* out_x, int* out_y)
+    {
+        int best_index = -1;
+        int best_top   = INT32_MAX;
+        int best_width = INT32_MAX;
+        int best_y     = 0;
+
+        for (int i = 0; i < static_cast<int>(skyline_.size()); ++i)
+        {
+            int y;
+            if (!Fit(i, width, height, &y))
+            {
+                continue;
+            }
+
+            int top = y + height;
+            if (top < best_top || (top == best_top && skyline_[i].width < best_width))
+            {
+                best_index = i;
+                best_top   = top;
+                best_width = skyline_[i].width;
+                best_y     = y;
+            }
+        }
+
+        if (best_index < 0)
+        {
+            return false;
+        }
+
+        *out_x = skyline_[best_index].x;
+        *out_y = best_y;
+        Insert(best_index, {*out_x, best_y + height, width});
+        return true;
+    }
+
+    // the lowest y at which a rectangle starting at segment `index` rests on the skyline
+    bool Fit(int index, int width, int height, int* out_y) const
+    {
+        int x = skyline_[index].x;
+        if (x + width > texture_->Width())
+        {
+            return false;
+        }
+
+        int y         = 0;
+        int remaining = width;
+        for (int i = index; remaining > 0; ++i)
+        {
+            y = std::max(y, skyline_[i].y);
+            if (y + height > texture_->Height())
+            {
+                return false;
+            }
+            remaining -= skyline_[i].width;
+        }
+
+        *out_y = y;
+        return true;
+    }
+
+    // raise the skyline under a newly placed rectangle
+    void Insert(int index, SkylineNode node)
+    {
+        skyline_.insert(skyline_.begin() + index, node);
+
+        // shrink or drop the segments that the new one covers
+        int right = node.x + node.width;
+        for (size_t i = index + 1; i < skyline_.size();)
+        {
+            SkylineNode& next = skyline_[i];
+            if (next.x >= right)
+            {
+                break;
+            }
+
+            int overlap = right - next.x;
+            if (overlap < next.width)
+            {
+                next.x += overlap;
+                next.width -= overlap;
+                break;
+            }
+            skyline_.erase(skyline_.begin() + i);
+        }
+
+        // merge neighbours at the same height
+        for (size_t i = 0; i + 1 < skyline_.size();)
+        {
+            if (skyline_[i].y == skyline_[i + 1].y)
+            {
+                skyline_[i].width += skyline_[i + 1].width;
+                skyline_.erase(skyline_.begin() + i + 1);
+            }
+            else
+            {
+                i += 1;
+            }
+        }
+    }
+
+    void ClearRect(int x, int y, int width, int height)
+    {
+        for (int row = 0; row < height; ++row)
+        {
+            memset(Pixel(x, y + row), 0, static_cast<size_t>(width) * bytes_per_pixel_);
+        }
+    }
+
+    void Upload(int x, int y, int width, int height)
+    {
+        int row_stride = texture_->Width() * bytes_per_pixel_;
+        texture_->UpdateRegion(x, y, width, height, Pixel(x, y), row_stride);
+    }
+
+    size_t PixelOffset(int x, int y) const
+    {
+        return (static_cast<size_t>(y) * texture_->Width() + x) * bytes_per_pixel_;
+    }
+    uint8_t* Pixel(int x, int y)
+    {
+        return &pixels_[PixelOffset(x, y)];
+    }
+
+    static int64_t PaddedArea(const Entry& entry)
+    {
+        return static_cast<int64_t>(entry.width + 2 * kPadding) * (entry.height + 2 * kPadding);
+    }
+
+    PlatformTexture::Ptr texture_;
+    int bytes_per_pixel_ = 4;
+
+    // replaced textures, kept until the frames referencing them have been rendered
+    std::vector<std::pair<PlatformTexture::Ptr, int>> retired_;
+
+    // CPU copy of the whole atlas, the source for defragmentation
+    std::vector<uint8_t> pixels_;
+
+    std::vector<SkylineNode> skyline_;
+    std::unordered_map<Handle, Entry> entries_;
+    Handle next_handle_ = 1;
+    int64_t used_area_  = 0;
+
+    std::function<void(Handle)> on_evict_;
+    uint64_t evictions_        = 0;
+    uint64_t defragmentations_ = 0;
+};
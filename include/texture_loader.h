@@ -0,0 +1,157 @@
+#pragma once
+#include "imgui.h"
+#include "platform.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct DecodedImage
+{
+    int width            = 0;
+    int height           = 0;
+    TextureFormat format = TextureFormat::Rgba8;
+
+    // tightly packed rows in `format`, top row first
+    std::vector<uint8_t> pixels;
+};
+
+// decodes an image file, called on the loader's worker threads
+using ImageDecoder = std::function<bool(const std::string& path, DecodedImage& image)>;
+
+// decodes PNG, JPEG, BMP, TGA and others to RGBA8 with stb_image
+// NOTE only available if stb_image.h was on the include path when QuickImGui was built, otherwise
+// this always fails and TextureLoaderConfig::decoder must be set
+bool DecodeImageFile(const std::string& path, DecodedImage& image);
+
+struct TextureLoaderConfig
+{
+    // 0 picks one less than the number of hardware threads, but at least one
+    int worker_count = 0;
+
+    // pixel data uploaded per TextureLoader::Update(), at least one image is uploaded per call
+    size_t upload_bytes_per_frame = 4 << 20;
+
+    ImageDecoder decoder = DecodeImageFile;
+
+    // called on a worker thread whenever an image has been decoded, e.g. to request a redraw in
+    // on-demand mode
+    std::function<void()> on_decoded;
+};
+
+class TextureRequest
+{
+public:
+    enum class State
+    {
+        Pending,
+        Ready,
+        Failed,
+    };
+
+    State GetState() const
+    {
+        return state_;
+    }
+    const std::string& Path() const
+    {
+        return path_;
+    }
+
+    // only set once Ready
+    PlatformTexture* Texture() const
+    {
+        return texture_.get();
+    }
+
+    // the texture once it is ready, the placeholder until then
+    ImTextureID Id() const
+    {
+        return texture_ != nullptr ? texture_->Id() : placeholder_;
+    }
+
+    // take ownership of the texture, Id() falls back to the placeholder afterwards
+    PlatformTexture::Ptr Release()
+    {
+        return std::move(texture_);
+    }
+
+private:
+    friend class TextureLoader;
+
+    std::string path_;
+    State state_ = State::Pending;
+    PlatformTexture::Ptr texture_;
+    ImTextureID placeholder_ = nullptr;
+};
+
+// decodes image files on a pool of worker threads and uploads the results on the main thread,
+// a bounded number of bytes per frame, so that loading many images never stalls a frame
+//
+// Requests are decoded most recent first, so that a view scrolling through a large folder loads
+// what is on screen before what it scrolled past. Dropping every reference to a request that has
+// not been decoded yet cancels it.
+//
+// NOTE Load() and Update() must be called on the main thread, Update() once per frame
+class TextureLoader
+{
+public:
+    using Ptr = std::shared_ptr<TextureRequest>;
+
+    explicit TextureLoader(TextureLoaderConfig config = {});
+    ~TextureLoader();
+
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+
+    // decode the file at `path` with the configured decoder
+    Ptr Load(const std::string& path);
+
+    // decode with `decode` instead, `name` is only reported by TextureRequest::Path()
+    Ptr Load(const std::string& name, std::function<bool(DecodedImage& image)> decode);
+
+    // upload decoded images within the per-frame budget, returns true while decoded images are
+    // still waiting, i.e. in on-demand mode another frame should be requested
+    bool Update();
+
+    // shown by requests that are not ready, a small gray texture
+    ImTextureID Placeholder();
+
+    // requests that are decoded or waiting for upload
+    int PendingCount() const;
+
+private:
+    struct Job
+    {
+        std::weak_ptr<TextureRequest> request;
+        std::function<bool(DecodedImage& image)> decode;
+    };
+
+    struct Decoded
+    {
+        std::weak_ptr<TextureRequest> request;
+        bool ok;
+        DecodedImage image;
+    };
+
+    void Work();
+
+    TextureLoaderConfig config_;
+    PlatformTexture::Ptr placeholder_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+
+    // guarded by mutex_, jobs are taken from the back
+    std::deque<Job> jobs_;
+    std::deque<Decoded> decoded_;
+    int decoding_ = 0;
+
+    std::vector<std::thread> workers_;
+};
@@ -0,0 +1,119 @@
+#pragma once
+#include "imgui.h"
+#include "texture_loader.h"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+// an image too large for a single texture, split into a mip pyramid of square tiles
+//
+// Level 0 is the full resolution, every further level halves both dimensions, rounding up, until
+// the image fits into a single tile. Tiles on the right and bottom edges are smaller.
+class TileSource
+{
+public:
+    virtual ~TileSource() = default;
+
+    // size of level 0
+    virtual int Width() const  = 0;
+    virtual int Height() const = 0;
+
+    virtual int TileSize() const
+    {
+        return 256;
+    }
+
+    // read tile (x, y) of `level` as RGBA8, called concurrently from worker threads
+    // NOTE sources without a stored pyramid can return DownsampleTile() for levels above 0
+    virtual bool ReadTile(int level, int x, int y, DecodedImage& tile) = 0;
+
+    int LevelCount() const;
+    int LevelWidth(int level) const;
+    int LevelHeight(int level) const;
+    int TilesX(int level) const;
+    int TilesY(int level) const;
+};
+
+// build a tile of `level` from the four tiles below it with a box filter
+// NOTE this recurses down to level 0, so the coarsest levels of a large image read all of it
+bool DownsampleTile(TileSource& source, int level, int x, int y, DecodedImage& tile);
+
+struct TiledImageViewConfig
+{
+    // tiles kept in textures, beyond that the least recently drawn ones are released
+    int max_cached_tiles = 512;
+
+    // the loader decoding the tiles, its decoder is not used
+    TextureLoaderConfig loader = {};
+};
+
+// a pannable, zoomable view of a TileSource
+//
+// Only the tiles visible at the current zoom are loaded, on background threads, and drawn as a
+// grid of images. Tiles that are not loaded yet are drawn from the closest coarser level that is.
+// Drag to pan, scroll to zoom around the cursor.
+class TiledImageView
+{
+public:
+    explicit TiledImageView(std::shared_ptr<TileSource> source, TiledImageViewConfig config = {});
+
+    // draw the view as an item of `size`, by default filling the remaining content region
+    // returns true while tiles are still loading, i.e. in on-demand mode another frame should be
+    // requested
+    bool Draw(const char* str_id, ImVec2 size = {0, 0});
+
+    // fit the whole image into the view on the next Draw()
+    void ResetView()
+    {
+        fit_pending_ = true;
+    }
+
+    // screen pixels per level 0 pixel
+    double Zoom() const
+    {
+        return zoom_;
+    }
+
+    int CachedTileCount() const
+    {
+        return static_cast<int>(tiles_.size());
+    }
+    int PendingTileCount() const
+    {
+        return loader_.PendingCount();
+    }
+
+private:
+    struct Tile
+    {
+        TextureLoader::Ptr request;
+        int last_used_frame = 0;
+    };
+
+    static uint64_t TileKey(int level, int x, int y)
+    {
+        return (static_cast<uint64_t>(level) << 48) | (static_cast<uint64_t>(y) << 24) |
+               static_cast<uint64_t>(x);
+    }
+
+    // find or request a tile, and mark it as used in this frame
+    Tile& UseTile(int level, int x, int y);
+
+    // the ready texture of a tile or nullptr, without requesting it
+    PlatformTexture* ReadyTile(int level, int x, int y);
+
+    void DrawTile(ImDrawList* draw_list, ImVec2 origin, int level, int x, int y);
+    void Trim();
+
+    std::shared_ptr<TileSource> source_;
+    TiledImageViewConfig config_;
+    TextureLoader loader_;
+
+    std::unordered_map<uint64_t, Tile> tiles_;
+
+    // level 0 pixel at the top left corner of the view
+    double view_x_    = 0.;
+    double view_y_    = 0.;
+    double zoom_      = 1.;
+    bool fit_pending_ = true;
+};
@@ -5,8 +5,12 @@
 #include "imgui_impl_win32.h"
 
 #include "application.h"
+#include "font_atlas_cache.h"
 #include "platform.h"
+#include "texture_memory.h"
+#include "texture_pool.h"
 
+#include <atomic>
 #include <d3d11.h>
 #define DIRECTINPUT_VERSION 0x0800
 #include <dinput.h>
@@ -21,6 +25,7 @@ namespace
     ID3D11DeviceContext* g_pd3dDeviceContext       = NULL;
     IDXGISwapChain* g_pSwapChain                   = NULL;
     ID3D11RenderTargetView* g_mainRenderTargetView = NULL;
+    std::atomic<HWND> g_hWnd                       = NULL;
 
     // Forward declarations of helper functions
     bool CreateDeviceD3D(HWND hWnd);
@@ -73,12 +78,48 @@ namespace
         }
     };
 
+    static PlatformTextureStats TextureStats;
+
+    // everything a recycled texture takes over from a released one
+    struct TextureResources
+    {
+        ID3D11ShaderResourceView* texSRV = nullptr;
+        ID3D11Texture2D* tex             = nullptr;
+        ID3D11Texture2D* uploadTex       = nullptr;
+    };
+
+    void DestroyTextureResources(TextureResources& resources)
+    {
+        if (resources.texSRV != nullptr)
+        {
+            resources.texSRV->Release();
+            resources.texSRV = nullptr;
+        }
+        if (resources.tex != nullptr)
+        {
+            resources.tex->Release();
+            resources.tex = nullptr;
+        }
+        if (resources.uploadTex != nullptr)
+        {
+            resources.uploadTex->Release();
+            resources.uploadTex = nullptr;
+        }
+    }
+
+    static TexturePool<TextureResources> RecycledTextures(&DestroyTextureResources, &TextureStats);
+
     class PlatformTexture_Dx11 final : public PlatformTexture
     {
     private:
         ID3D11ShaderResourceView* texSRV = nullptr;
         ID3D11Texture2D* tex             = nullptr;
 
+        // dynamic copy of the texture for Update(), created on first use. Dynamic textures can
+        // only be rewritten as a whole, so `tex` itself is a default texture that accepts
+        // UpdateSubresource for regions.
+        ID3D11Texture2D* uploadTex = nullptr;
+
     public:
         PlatformTexture_Dx11() = default;
         ~PlatformTexture_Dx11() override
@@ -86,28 +127,39 @@ namespace
             Cleanup();
         }
 
-        bool Initialize(int width, int height)
+        bool Initialize(int width, int height, TextureFormat format)
         {
             width_  = width;
             height_ = height;
+            format_ = format;
+
+            TextureResources recycled;
+            if (RecycledTextures.Acquire(width, height, format, &recycled))
+            {
+                texSRV    = recycled.texSRV;
+                tex       = recycled.tex;
+                uploadTex = recycled.uploadTex;
+                id_       = texSRV;
+                TextureMemory::Get().Track(this, TextureBytes(width, height, format));
+                return true;
+            }
 
             D3D11_TEXTURE2D_DESC desc = {};
             desc.Width                = width;
             desc.Height               = height;
             desc.MipLevels            = 1;
             desc.ArraySize            = 1;
-            desc.Format               = DXGI_FORMAT_R8G8B8A8_UNORM;
+            desc.Format               = ToDxgiFormat(format);
             desc.SampleDesc.Count     = 1;
-            desc.Usage                = D3D11_USAGE_DYNAMIC;
+            desc.Usage                = D3D11_USAGE_DEFAULT;
             desc.BindFlags            = D3D11_BIND_SHADER_RESOURCE;
-            desc.CPUAccessFlags       = D3D10_CPU_ACCESS_WRITE;
 
             HRESULT hr = g_pd3dDevice->CreateTexture2D(&desc, nullptr, &tex);
 
             if (SUCCEEDED(hr))
             {
                 D3D11_SHADER_RESOURCE_VIEW_DESC SRVDesc = {};
-                SRVDesc.Format                          = DXGI_FORMAT_R8G8B8A8_UNORM;
+                SRVDesc.Format                          = desc.Format;
                 SRVDesc.ViewDimension                   = D3D11_SRV_DIMENSION_TEXTURE2D;
                 SRVDesc.Texture2D.MipLevels             = 1;
 
@@ -115,6 +167,7 @@ namespace
                 if (SUCCEEDED(hr))
                 {
                     id_ = texSRV;
+                    TextureMemory::Get().Track(this, TextureBytes(width, height, format));
                     return true;
                 }
             }
@@ -125,59 +178,130 @@ namespace
 
         virtual void UpdateRgba(const void* p) override
         {
+            IM_ASSERT(Format() == TextureFormat::Rgba8 && "use UpdatePixels() for other formats");
+            UpdatePixels(p);
+        }
+
+        virtual void UpdateRegion(int x, int y, int width, int height, const void* p,
+                                  int row_stride) override
+        {
+            IM_ASSERT(x >= 0 && y >= 0 && x + width <= width_ && y + height <= height_);
+            if (width <= 0 || height <= 0)
+            {
+                return;
+            }
+
+            D3D11_BOX box = {};
+            box.left      = x;
+            box.top       = y;
+            box.front     = 0;
+            box.right     = x + width;
+            box.bottom    = y + height;
+            box.back      = 1;
+            g_pd3dDeviceContext->UpdateSubresource(tex, 0, &box, p, row_stride, 0);
+
+            TextureStats.uploads += 1;
+        }
+
+        virtual void Update(std::function<void(void* p, int row_pitch)> f) override
+        {
+            if (uploadTex == nullptr)
+            {
+                D3D11_TEXTURE2D_DESC desc;
+                tex->GetDesc(&desc);
+                desc.Usage          = D3D11_USAGE_DYNAMIC;
+                desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+                desc.BindFlags      = D3D11_BIND_SHADER_RESOURCE;
+
+                if (FAILED(g_pd3dDevice->CreateTexture2D(&desc, nullptr, &uploadTex)))
+                {
+                    uploadTex = nullptr;
+                    return;
+                }
+            }
+
             D3D11_MAPPED_SUBRESOURCE mapped_resource;
             ZeroMemory(&mapped_resource, sizeof(D3D11_MAPPED_SUBRESOURCE));
-            HRESULT hr =
-                g_pd3dDeviceContext->Map(tex, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped_resource);
+            HRESULT hr = g_pd3dDeviceContext->Map(uploadTex, 0, D3D11_MAP_WRITE_DISCARD, 0,
+                                                  &mapped_resource);
 
             if (SUCCEEDED(hr))
             {
-                const uint8_t* p_u8 = reinterpret_cast<const uint8_t*>(p);
-                uint8_t* buf_u8     = reinterpret_cast<uint8_t*>(mapped_resource.pData);
-                unsigned p_pitch    = 4 * width_;
-                unsigned buf_pitch  = mapped_resource.RowPitch;
-                for (int i = 0; i < height_; ++i)
+                try
+                {
+                    f(mapped_resource.pData, static_cast<int>(mapped_resource.RowPitch));
+                }
+                catch (...)
                 {
-                    memcpy(buf_u8, p_u8, 4 * width_);
-                    p_u8 += p_pitch;
-                    buf_u8 += buf_pitch;
+                    // the texture keeps its previous contents
+                    g_pd3dDeviceContext->Unmap(uploadTex, 0);
+                    throw;
                 }
+                g_pd3dDeviceContext->Unmap(uploadTex, 0);
+
+                // D3D11_MAP_WRITE_DISCARD renames the upload texture, the copy runs on the GPU
+                g_pd3dDeviceContext->CopyResource(tex, uploadTex);
 
-                g_pd3dDeviceContext->Unmap(tex, 0);
+                TextureStats.uploads += 1;
+                TextureStats.async_uploads += 1;
             }
         }
 
-        // virtual void Update(std::function<void(void* p, int row_pitch)> f) override
-        // {
-        //     D3D11_MAPPED_SUBRESOURCE mapped_resource;
-        //     ZeroMemory(&mapped_resource, sizeof(D3D11_MAPPED_SUBRESOURCE));
-        //     HRESULT hr = g_pd3dDeviceContext->Map(tex, 0, D3D11_MAP_WRITE_DISCARD, 0,
-        //     &mapped_resource);
-
-        //     if (SUCCEEDED(hr))
-        //     {
-        //         f(mapped_resource.pData, mapped_resource.RowPitch);
-
-        //         // TODO: exception safety
-        //         g_pd3dDeviceContext->Unmap(tex, 0);
-        //     }
-        // }
-
+        // hands the texture over to the pool, or releases what a failed Initialize() created
         void Cleanup()
         {
-            if (texSRV != nullptr)
+            TextureMemory::Get().Untrack(this);
+
+            TextureResources resources = {texSRV, tex, uploadTex};
+            if (texSRV != nullptr && tex != nullptr)
             {
-                texSRV->Release();
-                texSRV = nullptr;
+                size_t bytes = TextureBytes(width_, height_, format_);
+                if (uploadTex != nullptr)
+                {
+                    bytes *= 2;
+                }
+                RecycledTextures.Release(width_, height_, format_, bytes, resources);
             }
-            if (tex != nullptr)
+            else
             {
-                tex->Release();
-                tex = nullptr;
+                DestroyTextureResources(resources);
             }
 
+            texSRV    = nullptr;
+            tex       = nullptr;
+            uploadTex = nullptr;
             Clear();
         }
+
+    private:
+        static size_t TextureBytes(int width, int height, TextureFormat format)
+        {
+            return static_cast<size_t>(width) * height * BytesPerPixel(format);
+        }
+
+        // NOTE D3D11 views cannot swizzle, and imgui's pixel shader samples all four channels, so
+        // single channel textures show up red
+        static DXGI_FORMAT ToDxgiFormat(TextureFormat format)
+        {
+            switch (format)
+            {
+            case TextureFormat::Bgra8:
+                return DXGI_FORMAT_B8G8R8A8_UNORM;
+            case TextureFormat::R8:
+                return DXGI_FORMAT_R8_UNORM;
+            case TextureFormat::Rg8:
+                return DXGI_FORMAT_R8G8_UNORM;
+            case TextureFormat::R16F:
+                return DXGI_FORMAT_R16_FLOAT;
+            case TextureFormat::R32F:
+                return DXGI_FORMAT_R32_FLOAT;
+            case TextureFormat::Rgb565:
+                // requires DXGI 1.2, i.e. Windows 8
+                return DXGI_FORMAT_B5G6R5_UNORM;
+            default:
+                return DXGI_FORMAT_R8G8B8A8_UNORM;
+            }
+        }
     };
 
     static std::unique_ptr<PlatformWindow_Win32> CurrentWindow = nullptr;
@@ -185,6 +309,8 @@ namespace
     // Main Code
     int DoMain_Dx11_Win32(Application& app, const AppWindowConfig& window_config)
     {
+        StartupTimer startup;
+
         // Create application window
         WNDCLASSEX wc = {sizeof(WNDCLASSEX),         CS_CLASSDC, WndProc, 0L,   0L,
                          GetModuleHandle(NULL),      NULL,       NULL,    NULL, NULL,
@@ -206,6 +332,7 @@ namespace
         // Show the window
         ::ShowWindow(hwnd, SW_SHOWDEFAULT);
         ::UpdateWindow(hwnd);
+        startup.Mark(StartupStage::Window);
 
         // Setup Dear ImGui context
         IMGUI_CHECKVERSION();
@@ -222,6 +349,7 @@ namespace
         // Setup Platform/Renderer bindings
         ImGui_ImplWin32_Init(hwnd);
         ImGui_ImplDX11_Init(g_pd3dDevice, g_pd3dDeviceContext);
+        startup.Mark(StartupStage::Context);
 
         // Load Fonts
         // - If no fonts are loaded, dear imgui will use the default font. You can also load
@@ -244,8 +372,20 @@ namespace
         // NULL, io.Fonts->GetGlyphRangesJapanese()); IM_ASSERT(font != NULL);
 
         // Main loop
+        // NOTE on-demand rendering is only implemented by the glfw backend, this loop always
+        // redraws at vsync rate
         CurrentWindow = std::make_unique<PlatformWindow_Win32>(hwnd);
+        g_hWnd        = hwnd;
         app.Initialize();
+        startup.Mark(StartupStage::AppInit);
+
+        // Build the font atlas after Initialize(), so that fonts added there are included, or load
+        // it from the on-disk cache
+        BuildFontAtlas(app, *io.Fonts);
+        startup.Mark(StartupStage::FontAtlas);
+
+        FrameTimer timer;
+        timer.Begin();
 
         MSG msg;
         ZeroMemory(&msg, sizeof(msg));
@@ -265,29 +405,57 @@ namespace
                 ::DispatchMessage(&msg);
                 continue;
             }
+            timer.Mark(FramePhase::Events);
 
             // Start the Dear ImGui frame
             ImGui_ImplDX11_NewFrame();
             ImGui_ImplWin32_NewFrame();
             ImGui::NewFrame();
+            timer.Mark(FramePhase::NewFrame);
 
             // Update application state
             app.Update();
+            if (app.RenderingConfig().show_frame_stats)
+            {
+                ImGui::ShowFrameStatsOverlay(app.FrameStats(), app.FrameCounters());
+            }
+            timer.Mark(FramePhase::Update);
 
             // Rendering
             ImVec4 clear_color = app.RenderingConfig().bg_color;
 
             ImGui::Render();
+            TextureMemory::Get().Update(ImGui::GetDrawData());
+            timer.Mark(FramePhase::Render);
+
             g_pd3dDeviceContext->OMSetRenderTargets(1, &g_mainRenderTargetView, NULL);
             g_pd3dDeviceContext->ClearRenderTargetView(
                 g_mainRenderTargetView, reinterpret_cast<const float*>(&clear_color));
             ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+            timer.Mark(FramePhase::Submit);
 
             g_pSwapChain->Present(1, 0); // Present with vsync
+            timer.Mark(FramePhase::Present);
+
+            app.RecordRenderedFrame();
+            app.RecordFrameTiming(timer);
+            timer.Begin();
+
+            if (app.FrameCounters().rendered_frames == 1)
+            {
+                startup.Mark(StartupStage::FirstFrame);
+                app.RecordStartup(startup);
+                if (app.RenderingConfig().trace_startup)
+                {
+                    PrintStartupTrace(stderr, "DX11:", app.StartupStats());
+                }
+            }
 
             // g_pSwapChain->Present(0, 0); // Present without vsync
         }
 
+        g_hWnd = NULL;
+        RecycledTextures.Clear();
         ImGui_ImplDX11_Shutdown();
         ImGui_ImplWin32_Shutdown();
         ImGui::DestroyContext();
@@ -404,15 +572,50 @@ namespace
     }
 } // namespace
 
+void WakeMainLoop()
+{
+    HWND hwnd = g_hWnd;
+    if (hwnd != NULL)
+    {
+        ::PostMessage(hwnd, WM_NULL, 0, 0);
+    }
+}
+
 PlatformWindow& GetCurrentWindow()
 {
     return *CurrentWindow;
 }
 
-std::unique_ptr<PlatformTexture> AllocateTexture(int width, int height)
+// NOTE the DX11 backend has a single window
+std::unique_ptr<PlatformWindow> OpenWindow(const AppWindowConfig&, std::function<void()>)
+{
+    return nullptr;
+}
+
+const PlatformTextureStats& GetTextureStats()
+{
+    return TextureStats;
+}
+
+void SetTexturePoolCapacity(size_t bytes)
+{
+    RecycledTextures.SetCapacity(bytes);
+}
+
+const TextureMemoryStats& GetTextureMemoryStats()
+{
+    return TextureMemory::Get().Stats();
+}
+
+void SetTextureMemoryBudget(size_t bytes)
+{
+    TextureMemory::Get().SetBudget(bytes);
+}
+
+std::unique_ptr<PlatformTexture> AllocateTexture(int width, int height, TextureFormat format)
 {
     auto result = std::make_unique<PlatformTexture_Dx11>();
-    if (!result->Initialize(width, height))
+    if (!result->Initialize(width, height, format))
     {
         return nullptr;
     }
@@ -420,6 +623,12 @@ std::unique_ptr<PlatformTexture> AllocateTexture(int width, int height)
     return result;
 }
 
+// NOTE the DX11 backend does not render into textures
+bool RenderToTexture(PlatformTexture&, ImDrawData*, ImVec4)
+{
+    return false;
+}
+
 int RunApplication(Application& app, AppWindowConfig window_config)
 {
     return DoMain_Dx11_Win32(app, window_config);
@@ -4,11 +4,27 @@
 
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
-#include "imgui_impl_opengl3.h"
 
 #include "application.h"
 #include "platform.h"
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <condition_variable>
 #include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// GLFW_EXPOSE_NATIVE_EGL is defined by CMake when EGL is found, see QUICK_IMGUI_EGL_DAMAGE, so that
+// partial redraws are presented with EGL_KHR_swap_buffers_with_damage when GLFW creates its
+// contexts with EGL (e.g. on Wayland). EGL must be included before glad, whose bundled
+// khrplatform.h lacks the definitions EGL needs.
+#if defined(GLFW_EXPOSE_NATIVE_EGL)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
 
 // About Desktop OpenGL function loaders:
 //  Modern desktop OpenGL doesn't have a standard portable header file to load OpenGL function
@@ -23,6 +39,7 @@
 #include <glad/glad.h> // Initialize with gladLoadGL()
 #elif defined(IMGUI_IMPL_OPENGL_LOADER_GLAD2)
 #include <glad/gl.h> // Initialize with gladLoadGL(...) or gladLoaderLoadGL()
+#include "gl_lazy_loader.h"
 #elif defined(IMGUI_IMPL_OPENGL_LOADER_GLBINDING2)
 #define GLFW_INCLUDE_NONE // GLFW including OpenGL headers causes ambiguity or multiple definition
                           // errors.
@@ -41,6 +58,19 @@ using namespace gl;
 
 // Include glfw3.h after our OpenGL definitions
 #include <GLFW/glfw3.h>
+#if defined(GLFW_EXPOSE_NATIVE_EGL)
+#include <GLFW/glfw3native.h>
+#endif
+
+#include "damage_tracker.h"
+#include "draw_data_hash.h"
+#include "draw_data_snapshot.h"
+#include "dynamic_font_atlas.h"
+#include "font_atlas_cache.h"
+#include "gl_ext.h"
+#include "renderer_gl3.h"
+#include "texture_gl3.h"
+#include "texture_memory.h"
 
 // [Win32] Our example includes a copy of glfw3.lib pre-compiled with VS2010 to maximize ease of
 // testing and compatibility with old VS compilers. To link with VS2010-era libraries, VS2015+
@@ -92,65 +122,835 @@ namespace
         }
     };
 
-    class PlatformTexture_Gl3 final : public PlatformTexture
+    static std::unique_ptr<PlatformWindow_Glfw> CurrentWindow = nullptr;
+
+    // in on-demand mode, keep drawing a few frames after an input event so that imgui can settle
+    // hover states and window layout
+    constexpr int kFramesAfterEvent = 3;
+
+    static bool EventReceived = false;
+
+    // the window contents were lost, e.g. after being uncovered, so the next frame must be
+    // presented even if it is identical to the last one
+    static bool WindowDamaged = false;
+
+    // glfwPostEmptyEvent must not be called outside of glfwInit/glfwTerminate
+    static std::atomic<bool> MainLoopRunning{false};
+
+    void glfw_error_callback(int error, const char* description)
+    {
+        fprintf(stderr, "Glfw Error %d: %s\n", error, description);
+    }
+
+    // installed before imgui's callbacks, which chain to the previously installed ones
+    void InstallEventCallbacks(GLFWwindow* window)
+    {
+        glfwSetMouseButtonCallback(window,
+                                   [](GLFWwindow*, int, int, int) { EventReceived = true; });
+        glfwSetScrollCallback(window, [](GLFWwindow*, double, double) { EventReceived = true; });
+        glfwSetKeyCallback(window, [](GLFWwindow*, int, int, int, int) { EventReceived = true; });
+        glfwSetCharCallback(window, [](GLFWwindow*, unsigned int) { EventReceived = true; });
+        glfwSetCursorPosCallback(window,
+                                 [](GLFWwindow*, double, double) { EventReceived = true; });
+        glfwSetCursorEnterCallback(window, [](GLFWwindow*, int) { EventReceived = true; });
+        glfwSetWindowSizeCallback(window, [](GLFWwindow*, int, int) { EventReceived = true; });
+        glfwSetWindowRefreshCallback(window, [](GLFWwindow*) {
+            EventReceived = true;
+            WindowDamaged = true;
+        });
+        glfwSetWindowFocusCallback(window, [](GLFWwindow*, int) { EventReceived = true; });
+    }
+
+    // the imgui context of the main window, whose font atlas the other windows share
+    static ImGuiContext* MainContext = nullptr;
+
+    // the contexts of other windows are created sharing objects with this window's one, NULL
+    // outside of the main loop
+    static GLFWwindow* SharedContextWindow = nullptr;
+
+    // set while a window opened by OpenWindow() builds its frame, see GetCurrentWindow()
+    static PlatformWindow* ActiveWindow = nullptr;
+
+    // a window opened by OpenWindow(), whose frame is built and rendered by the main loop along
+    // with the main window's one, with an imgui context of its own and input fed from its callbacks
+    class SecondaryWindow_Glfw;
+    static std::vector<SecondaryWindow_Glfw*> SecondaryWindows;
+
+    class SecondaryWindow_Glfw final : public PlatformWindow
     {
     private:
-        GLuint tex_ = 0;
+        GLFWwindow* window_    = nullptr;
+        ImGuiContext* context_ = nullptr;
+        std::function<void()> draw_;
+
+        // the frame built last, until the next one is built
+        ImDrawData* draw_data_ = nullptr;
+
+        double time_                = 0.;
+        bool mouse_just_pressed_[5] = {};
 
     public:
-        PlatformTexture_Gl3() = default;
-        ~PlatformTexture_Gl3() override
+        SecondaryWindow_Glfw(GLFWwindow* window, ImGuiContext* context, std::function<void()> draw)
+        {
+            window_  = window;
+            context_ = context;
+            draw_    = std::move(draw);
+            InstallCallbacks();
+            SecondaryWindows.push_back(this);
+        }
+        ~SecondaryWindow_Glfw() override
         {
-            Cleanup();
+            Destroy();
         }
 
-        bool Initialize(int width, int height)
+        virtual void SetTitle(const std::string& title) override
         {
-            GLuint tex;
-            glGenTextures(1, &tex);
-            glBindTexture(GL_TEXTURE_2D, tex);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glfwSetWindowTitle(window_, title.c_str());
+        }
 
-            glActiveTexture(tex);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
-                         nullptr);
+        virtual void SetSize(int width, int height) override
+        {
+            glfwSetWindowSize(window_, width, height);
+        }
+        virtual std::pair<int, int> GetSize() override
+        {
+            int width, height;
+            glfwGetWindowSize(window_, &width, &height);
+            return {width, height};
+        }
 
-            width_  = width;
-            height_ = height;
-            id_     = reinterpret_cast<ImTextureID>((uintptr_t)tex);
-            tex_    = tex;
-            return true;
+        virtual void SetPosition(int x, int y) override
+        {
+            glfwSetWindowPos(window_, x, y);
+        }
+        virtual std::pair<int, int> GetPosition() override
+        {
+            int x, y;
+            glfwGetWindowPos(window_, &x, &y);
+            return {x, y};
         }
 
-        virtual void UpdateRgba(const void* p) override
+        virtual bool IsOpen() override
         {
-            glActiveTexture(tex_);
-            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, p);
+            return window_ != nullptr && glfwGetWindowAttrib(window_, GLFW_VISIBLE);
         }
 
-        void Cleanup()
+        // of the frame built last, null if it was not built
+        ImDrawData* DrawData() const
+        {
+            return draw_data_;
+        }
+
+        // build this window's frame on its imgui context, the current one is restored
+        void BuildFrame()
+        {
+            draw_data_ = nullptr;
+            if (!IsOpen())
+            {
+                return;
+            }
+
+            ImGuiContext* previous = ImGui::GetCurrentContext();
+            ImGui::SetCurrentContext(context_);
+            UpdateInput();
+
+            ActiveWindow = this;
+            ImGui::NewFrame();
+            draw_();
+            ImGui::Render();
+            ActiveWindow = nullptr;
+
+            draw_data_ = ImGui::GetDrawData();
+            ImGui::SetCurrentContext(previous);
+        }
+
+        // render and present the frame built last on this window's GL context, which is left
+        // current. `uploads_done` is signaled once the textures it draws are uploaded, if not null.
+        // NOTE the swap does not wait for vsync, see OpenWindow()
+        void Render(ImVec4 clear_color, GLsync uploads_done)
+        {
+            if (draw_data_ == nullptr)
+            {
+                return;
+            }
+
+            glfwMakeContextCurrent(window_);
+            if (uploads_done != nullptr)
+            {
+                GlExt().WaitSync(uploads_done, 0, GL_TIMEOUT_IGNORED);
+            }
+
+            int display_w, display_h;
+            glfwGetFramebufferSize(window_, &display_w, &display_h);
+            glViewport(0, 0, display_w, display_h);
+            glClearColor(clear_color.x, clear_color.y, clear_color.z, clear_color.w);
+            glClear(GL_COLOR_BUFFER_BIT);
+            Renderer_Gl3::RenderDrawData(draw_data_);
+            glfwSwapBuffers(window_);
+        }
+
+        // also called for the windows still open when the main loop ends, before GLFW terminates
+        void Destroy()
+        {
+            if (window_ == nullptr)
+            {
+                return;
+            }
+
+            // the main loop may be iterating, the entry is removed after its frame is built
+            *std::find(SecondaryWindows.begin(), SecondaryWindows.end(), this) = nullptr;
+
+            GLFWwindow* current = glfwGetCurrentContext();
+            glfwMakeContextCurrent(window_);
+            Renderer_Gl3::ReleaseContext();
+            glfwMakeContextCurrent(current != window_ ? current : NULL);
+
+            ImGui::DestroyContext(context_);
+            glfwDestroyWindow(window_);
+            window_    = nullptr;
+            context_   = nullptr;
+            draw_data_ = nullptr;
+        }
+
+    private:
+        static SecondaryWindow_Glfw* From(GLFWwindow* window)
+        {
+            return static_cast<SecondaryWindow_Glfw*>(glfwGetWindowUserPointer(window));
+        }
+
+        // the IO of this window's context, which need not be the current one
+        ImGuiIO& IO()
+        {
+            ImGuiContext* previous = ImGui::GetCurrentContext();
+            ImGui::SetCurrentContext(context_);
+            ImGuiIO& io = ImGui::GetIO();
+            ImGui::SetCurrentContext(previous);
+            return io;
+        }
+
+        // what imgui_impl_glfw does for the main window, whose callbacks only know one window
+        void InstallCallbacks()
+        {
+            glfwSetWindowUserPointer(window_, this);
+            InstallEventCallbacks(window_);
+
+            glfwSetMouseButtonCallback(window_, [](GLFWwindow* w, int button, int action, int) {
+                SecondaryWindow_Glfw* self = From(w);
+                if (action == GLFW_PRESS && button >= 0 &&
+                    button < IM_ARRAYSIZE(self->mouse_just_pressed_))
+                {
+                    self->mouse_just_pressed_[button] = true;
+                }
+                EventReceived = true;
+            });
+            glfwSetScrollCallback(window_, [](GLFWwindow* w, double x, double y) {
+                ImGuiIO& io = From(w)->IO();
+                io.MouseWheelH += static_cast<float>(x);
+                io.MouseWheel += static_cast<float>(y);
+                EventReceived = true;
+            });
+            glfwSetKeyCallback(window_, [](GLFWwindow* w, int key, int, int action, int) {
+                ImGuiIO& io = From(w)->IO();
+                if (key >= 0 && key < IM_ARRAYSIZE(io.KeysDown))
+                {
+                    if (action == GLFW_PRESS)
+                        io.KeysDown[key] = true;
+                    if (action == GLFW_RELEASE)
+                        io.KeysDown[key] = false;
+                }
+                const bool* down = io.KeysDown;
+                io.KeyCtrl       = down[GLFW_KEY_LEFT_CONTROL] || down[GLFW_KEY_RIGHT_CONTROL];
+                io.KeyShift      = down[GLFW_KEY_LEFT_SHIFT] || down[GLFW_KEY_RIGHT_SHIFT];
+                io.KeyAlt        = down[GLFW_KEY_LEFT_ALT] || down[GLFW_KEY_RIGHT_ALT];
+                io.KeySuper      = down[GLFW_KEY_LEFT_SUPER] || down[GLFW_KEY_RIGHT_SUPER];
+
+                EventReceived = true;
+            });
+            glfwSetCharCallback(window_, [](GLFWwindow* w, unsigned int c) {
+                From(w)->IO().AddInputCharacter(c);
+                EventReceived = true;
+            });
+
+            // closing only hides the window, its owner decides when to destroy it
+            glfwSetWindowCloseCallback(window_, [](GLFWwindow* w) {
+                glfwSetWindowShouldClose(w, GLFW_FALSE);
+                glfwHideWindow(w);
+                EventReceived = true;
+            });
+        }
+
+        // called with this window's imgui context current
+        void UpdateInput()
         {
-            glDeleteTextures(1, &tex_);
-            tex_ = 0;
+            ImGuiIO& io = ImGui::GetIO();
 
-            Clear();
+            int width, height, display_w, display_h;
+            glfwGetWindowSize(window_, &width, &height);
+            glfwGetFramebufferSize(window_, &display_w, &display_h);
+            io.DisplaySize = ImVec2(static_cast<float>(width), static_cast<float>(height));
+            if (width > 0 && height > 0)
+            {
+                io.DisplayFramebufferScale =
+                    ImVec2(static_cast<float>(display_w) / width,
+                           static_cast<float>(display_h) / height);
+            }
+
+            double now   = glfwGetTime();
+            io.DeltaTime = time_ > 0. ? std::max(static_cast<float>(now - time_), 1e-4f)
+                                      : 1.f / 60.f;
+            time_        = now;
+
+            for (int i = 0; i < IM_ARRAYSIZE(mouse_just_pressed_); ++i)
+            {
+                // a press and release within one frame still registers as a click
+                io.MouseDown[i] = mouse_just_pressed_[i] || glfwGetMouseButton(window_, i) != 0;
+                mouse_just_pressed_[i] = false;
+            }
+
+            io.MousePos = ImVec2(-FLT_MAX, -FLT_MAX);
+            if (glfwGetWindowAttrib(window_, GLFW_FOCUSED))
+            {
+                double x, y;
+                glfwGetCursorPos(window_, &x, &y);
+                io.MousePos = ImVec2(static_cast<float>(x), static_cast<float>(y));
+            }
         }
     };
 
-    static std::unique_ptr<PlatformWindow_Glfw> CurrentWindow = nullptr;
+    // build the frames of the windows opened by OpenWindow(), including those opened or destroyed
+    // by the `draw` functions of others
+    void BuildSecondaryFrames()
+    {
+        for (size_t i = 0; i < SecondaryWindows.size(); ++i)
+        {
+            if (SecondaryWindows[i] != nullptr)
+            {
+                SecondaryWindows[i]->BuildFrame();
+            }
+        }
 
-    void glfw_error_callback(int error, const char* description)
+        auto removed = std::remove(SecondaryWindows.begin(), SecondaryWindows.end(), nullptr);
+        SecondaryWindows.erase(removed, SecondaryWindows.end());
+    }
+
+    // render and present the frames of the windows opened by OpenWindow() on their own contexts,
+    // then make the current context, where the textures of this frame were uploaded, current again
+    //
+    // Their swaps do not wait for vsync, so that N windows cost one vsync wait, the main window's.
+    void RenderSecondaryFrames(ImVec4 clear_color)
     {
-        fprintf(stderr, "Glfw Error %d: %s\n", error, description);
+        if (std::none_of(SecondaryWindows.begin(), SecondaryWindows.end(),
+                         [](SecondaryWindow_Glfw* window) { return window && window->DrawData(); }))
+        {
+            return;
+        }
+
+        GLFWwindow* current = glfwGetCurrentContext();
+        GLsync uploads_done = nullptr;
+        if (GlExt().HasSync())
+        {
+            uploads_done = GlExt().FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            glFlush();
+        }
+        else
+        {
+            glFinish();
+        }
+
+        for (SecondaryWindow_Glfw* window : SecondaryWindows)
+        {
+            if (window != nullptr)
+            {
+                window->Render(clear_color, uploads_done);
+            }
+        }
+
+        glfwMakeContextCurrent(current);
+        if (uploads_done != nullptr)
+        {
+            GlExt().DeleteSync(uploads_done);
+        }
     }
 
+    int QueryRefreshRate(GLFWwindow* window)
+    {
+        GLFWmonitor* monitor = glfwGetWindowMonitor(window);
+        if (monitor == nullptr)
+        {
+            monitor = glfwGetPrimaryMonitor();
+        }
+
+        const GLFWvidmode* mode = monitor != nullptr ? glfwGetVideoMode(monitor) : nullptr;
+        return mode != nullptr && mode->refreshRate > 0 ? mode->refreshRate : 60;
+    }
+
+    // poll or wait for events depending on the rendering mode, returns false if no frame needs to
+    // be drawn. The frame timer starts after any idle wait.
+    bool ProcessEvents(Application& app, int& pending_frames, FrameTimer& timer)
+    {
+        if (!app.RenderingConfig().on_demand)
+        {
+            timer.Begin();
+            glfwPollEvents();
+            return true;
+        }
+
+        bool redraw = app.ConsumeRedrawRequest();
+        if (redraw || pending_frames > 0)
+        {
+            timer.Begin();
+            glfwPollEvents();
+        }
+        else
+        {
+            double timeout = app.SecondsUntilRedraw();
+            if (timeout < 0)
+            {
+                glfwWaitEvents();
+            }
+            else
+            {
+                glfwWaitEventsTimeout(timeout);
+            }
+
+            timer.Begin();
+            redraw = app.ConsumeRedrawRequest();
+        }
+
+        if (EventReceived)
+        {
+            EventReceived  = false;
+            pending_frames = kFramesAfterEvent;
+        }
+
+        if (pending_frames > 0)
+        {
+            pending_frames -= 1;
+            redraw = true;
+        }
+
+        return redraw;
+    }
+
+#if defined(GLFW_EXPOSE_NATIVE_EGL)
+    // present with a hint to the compositor about the damaged region, returns false if GLFW does
+    // not run on EGL or the driver lacks EGL_KHR_swap_buffers_with_damage
+    bool SwapBuffersWithDamage(GLFWwindow* window, const std::vector<int>& rects)
+    {
+        // NOTE glfwGetEGLSurface() reports an error for windows without an EGL context
+        EGLDisplay display = glfwGetEGLDisplay();
+        if (display == EGL_NO_DISPLAY)
+        {
+            return false;
+        }
+        EGLSurface surface = glfwGetEGLSurface(window);
+        if (surface == EGL_NO_SURFACE)
+        {
+            return false;
+        }
+
+        static const auto swap_with_damage = [display] {
+            const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+            if (extensions != nullptr &&
+                strstr(extensions, "EGL_KHR_swap_buffers_with_damage") != nullptr)
+            {
+                return reinterpret_cast<PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC>(
+                    eglGetProcAddress("eglSwapBuffersWithDamageKHR"));
+            }
+            if (extensions != nullptr &&
+                strstr(extensions, "EGL_EXT_swap_buffers_with_damage") != nullptr)
+            {
+                return reinterpret_cast<PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC>(
+                    eglGetProcAddress("eglSwapBuffersWithDamageEXT"));
+            }
+            return static_cast<PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC>(nullptr);
+        }();
+        if (swap_with_damage == nullptr)
+        {
+            return false;
+        }
+
+        EGLint egl_rects[4 * DamageTracker::kMaxRects];
+        int num_values = std::min(static_cast<int>(rects.size()), 4 * DamageTracker::kMaxRects);
+        std::copy(rects.begin(), rects.begin() + num_values, egl_rects);
+        return swap_with_damage(display, surface, egl_rects, num_values / 4) == EGL_TRUE;
+    }
+#endif
+
+    // redraws only the damaged regions of each frame into a framebuffer that is kept across
+    // frames, which is then copied to the window's back buffer
+    // NOTE the framebuffer belongs to the window's context, which must be current in all calls
+    class PartialRenderer
+    {
+    private:
+        GLuint fbo_   = 0;
+        GLuint color_ = 0;
+        int width_    = 0;
+        int height_   = 0;
+
+        DamageTracker damage_;
+        DrawDataSnapshot clipped_;
+        uint64_t state_hash_ = 0;
+
+        // redrawn rectangles of the last frame in framebuffer pixels as x, y, width, height, with
+        // the origin at the bottom left
+        std::vector<int> swap_rects_;
+        bool full_redraw_ = true;
+
+    public:
+        // `upload_count` is PlatformTexture_Gl3::Stats().uploads at the end of the frame, any
+        // upload forces a full redraw
+        // `sources` identify the draw lists if `draw_data` is a snapshot, see DamageTracker
+        void Render(ImDrawData* draw_data, int display_w, int display_h, ImVec4 clear_color,
+                    uint64_t upload_count, const ImDrawList* const* sources = nullptr)
+        {
+            const uint64_t frame_state[] = {static_cast<uint64_t>(display_w),
+                                            static_cast<uint64_t>(display_h), upload_count};
+            uint64_t state_hash = HashBytes(&clear_color, sizeof(clear_color));
+            state_hash          = HashBytes(frame_state, sizeof(frame_state), state_hash);
+            if (state_hash != state_hash_)
+            {
+                damage_.Invalidate();
+                state_hash_ = state_hash;
+            }
+            full_redraw_ = !damage_.Update(draw_data, sources);
+            swap_rects_.clear();
+
+            if (display_w <= 0 || display_h <= 0 || !BindFramebuffer(display_w, display_h))
+            {
+                // e.g. minimized, nothing is retained
+                damage_.Invalidate();
+                return;
+            }
+
+            glViewport(0, 0, display_w, display_h);
+            glClearColor(clear_color.x, clear_color.y, clear_color.z, clear_color.w);
+            if (full_redraw_)
+            {
+                glClear(GL_COLOR_BUFFER_BIT);
+                Renderer_Gl3::RenderDrawData(draw_data);
+            }
+            else
+            {
+                // The renderer sets its own scissor for every command, so the damaged rectangle is
+                // applied to the clip rectangles of a copy of the draw data
+                clipped_.Capture(draw_data);
+                glEnable(GL_SCISSOR_TEST);
+                for (const ImVec4& rect : damage_.Rects())
+                {
+                    // same transform as the renderer applies to clip rectangles
+                    ImVec2 off   = draw_data->DisplayPos;
+                    ImVec2 scale = draw_data->FramebufferScale;
+                    int x1 = std::clamp(static_cast<int>((rect.x - off.x) * scale.x), 0, display_w);
+                    int y1 = std::clamp(static_cast<int>((rect.y - off.y) * scale.y), 0, display_h);
+                    int x2 = std::clamp(static_cast<int>((rect.z - off.x) * scale.x), 0, display_w);
+                    int y2 = std::clamp(static_cast<int>((rect.w - off.y) * scale.y), 0, display_h);
+                    if (x1 >= x2 || y1 >= y2)
+                    {
+                        continue;
+                    }
+
+                    glScissor(x1, display_h - y2, x2 - x1, y2 - y1);
+                    glClear(GL_COLOR_BUFFER_BIT);
+
+                    ClipDrawData(draw_data, clipped_.DrawData(), rect);
+                    Renderer_Gl3::RenderDrawData(clipped_.DrawData());
+
+                    swap_rects_.insert(swap_rects_.end(),
+                                       {x1, display_h - y2, x2 - x1, y2 - y1});
+                }
+                glDisable(GL_SCISSOR_TEST);
+            }
+
+            // The back buffer is undefined after every swap, copy the whole retained image
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo_);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+            glBlitFramebuffer(0, 0, display_w, display_h, 0, 0, display_w, display_h,
+                              GL_COLOR_BUFFER_BIT, GL_NEAREST);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        }
+
+        void Present(GLFWwindow* window)
+        {
+#if defined(GLFW_EXPOSE_NATIVE_EGL)
+            // NOTE no rectangles would mean that the whole surface is damaged
+            if (!full_redraw_ && !swap_rects_.empty() && SwapBuffersWithDamage(window, swap_rects_))
+            {
+                return;
+            }
+#endif
+            glfwSwapBuffers(window);
+        }
+
+        // the next frame is redrawn in full, e.g. after frames were rendered without us
+        void Invalidate()
+        {
+            damage_.Invalidate();
+        }
+
+        void Cleanup()
+        {
+            DestroyFramebuffer();
+            damage_.Invalidate();
+        }
+
+    private:
+        bool BindFramebuffer(int width, int height)
+        {
+            if (fbo_ == 0 || width_ != width || height_ != height)
+            {
+                DestroyFramebuffer();
+                full_redraw_ = true;
+
+                glGenRenderbuffers(1, &color_);
+                glBindRenderbuffer(GL_RENDERBUFFER, color_);
+                glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+                glGenFramebuffers(1, &fbo_);
+                glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+                glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER,
+                                          color_);
+
+                if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+                {
+                    DestroyFramebuffer();
+                    return false;
+                }
+
+                width_  = width;
+                height_ = height;
+            }
+
+            glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+            return true;
+        }
+
+        void DestroyFramebuffer()
+        {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            if (fbo_ != 0)
+            {
+                glDeleteFramebuffers(1, &fbo_);
+                fbo_ = 0;
+            }
+            if (color_ != 0)
+            {
+                glDeleteRenderbuffers(1, &color_);
+                color_ = 0;
+            }
+
+            width_  = 0;
+            height_ = 0;
+        }
+
+        // intersect the clip rectangles of `src` with `rect` into the matching commands of `dst`,
+        // empty intersections become zero-sized scissors
+        static void ClipDrawData(const ImDrawData* src, ImDrawData* dst, const ImVec4& rect)
+        {
+            for (int i = 0; i < src->CmdListsCount; ++i)
+            {
+                const ImVector<ImDrawCmd>& cmds = src->CmdLists[i]->CmdBuffer;
+                ImVector<ImDrawCmd>& out_cmds   = dst->CmdLists[i]->CmdBuffer;
+                for (int j = 0; j < cmds.Size; ++j)
+                {
+                    const ImVec4& clip = cmds[j].ClipRect;
+                    ImVec4& out        = out_cmds[j].ClipRect;
+                    out.x              = std::max(clip.x, rect.x);
+                    out.y              = std::max(clip.y, rect.y);
+                    out.z              = std::max(out.x, std::min(clip.z, rect.z));
+                    out.w              = std::max(out.y, std::min(clip.w, rect.w));
+                }
+            }
+        }
+    };
+
+    // renders snapshots of the draw data on a thread that owns the window's context, while the main
+    // thread builds the next frame on a hidden context sharing its objects
+    //
+    // NOTE textures updated or released during Update() may still be sampled by the frame in flight
+    class RenderThread
+    {
+    private:
+        struct Frame
+        {
+            DrawDataSnapshot snapshot;
+            int display_w         = 0;
+            int display_h         = 0;
+            ImVec4 clear_color    = {};
+            uint64_t upload_count = 0;
+
+            // signaled once the uploads issued on the main thread before this frame have completed
+            GLsync uploads_done = nullptr;
+        };
+
+        GLFWwindow* window_ = nullptr;
+        std::thread thread_;
+
+        bool partial_redraw_ = false;
+        PartialRenderer partial_renderer_;
+
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        Frame frames_[2];
+        int pending_   = -1; // submitted but not picked up yet
+        int rendering_ = -1;
+        bool stop_     = false;
+
+    public:
+        ~RenderThread()
+        {
+            Stop();
+        }
+
+        // the window's context must not be current on any other thread
+        void Start(GLFWwindow* window, bool partial_redraw)
+        {
+            window_         = window;
+            partial_redraw_ = partial_redraw;
+            stop_           = false;
+            thread_ = std::thread([this] { Run(); });
+        }
+
+        void Stop()
+        {
+            if (!thread_.joinable())
+            {
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            cv_.notify_all();
+            thread_.join();
+
+            for (auto& frame : frames_)
+            {
+                DeleteFence(frame);
+            }
+            pending_ = -1;
+        }
+
+        // wait until a frame slot is free, i.e. the render thread has picked up the previous
+        // frame. This is where the main thread is throttled by vsync.
+        void WaitForSlot()
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return pending_ < 0; });
+        }
+
+        // hand over the frame that was just built, WaitForSlot() must have been called
+        void Submit(const ImDrawData* draw_data, int display_w, int display_h, ImVec4 clear_color)
+        {
+            int slot;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                slot = rendering_ == 0 ? 1 : 0;
+            }
+
+            Frame& frame = frames_[slot];
+            frame.snapshot.Capture(draw_data);
+            frame.display_w    = display_w;
+            frame.display_h    = display_h;
+            frame.clear_color  = clear_color;
+            frame.upload_count = PlatformTexture_Gl3::Stats().uploads;
+
+            // make texture uploads of this frame visible to the render context
+            DeleteFence(frame);
+            if (GlExt().HasSync())
+            {
+                frame.uploads_done = GlExt().FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                glFlush();
+            }
+            else
+            {
+                glFinish();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                pending_ = slot;
+            }
+            cv_.notify_all();
+        }
+
+    private:
+        void Run()
+        {
+            glfwMakeContextCurrent(window_);
+            glfwSwapInterval(1); // Enable vsync
+
+            while (true)
+            {
+                int slot;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    cv_.wait(lock, [this] { return stop_ || pending_ >= 0; });
+                    if (stop_)
+                    {
+                        break;
+                    }
+
+                    slot       = pending_;
+                    rendering_ = slot;
+                    pending_   = -1;
+                }
+                cv_.notify_all();
+
+                Frame& frame = frames_[slot];
+                if (frame.uploads_done != nullptr)
+                {
+                    GlExt().WaitSync(frame.uploads_done, 0, GL_TIMEOUT_IGNORED);
+                }
+
+                if (partial_redraw_)
+                {
+                    partial_renderer_.Render(frame.snapshot.DrawData(), frame.display_w,
+                                             frame.display_h, frame.clear_color,
+                                             frame.upload_count, frame.snapshot.SourceLists());
+                    partial_renderer_.Present(window_);
+                }
+                else
+                {
+                    const ImVec4& clear_color = frame.clear_color;
+                    glViewport(0, 0, frame.display_w, frame.display_h);
+                    glClearColor(clear_color.x, clear_color.y, clear_color.z, clear_color.w);
+                    glClear(GL_COLOR_BUFFER_BIT);
+                    Renderer_Gl3::RenderDrawData(frame.snapshot.DrawData());
+                    glfwSwapBuffers(window_);
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    rendering_ = -1;
+                }
+            }
+
+            partial_renderer_.Cleanup();
+            Renderer_Gl3::ReleaseContext();
+            glfwMakeContextCurrent(NULL);
+        }
+
+        static void DeleteFence(Frame& frame)
+        {
+            if (frame.uploads_done != nullptr)
+            {
+                GlExt().DeleteSync(frame.uploads_done);
+                frame.uploads_done = nullptr;
+            }
+        }
+    };
+
     int DoMain_GL3_GLFW(Application& app, const AppWindowConfig& window_config)
     {
+        StartupTimer startup;
+
         // Setup window
         glfwSetErrorCallback(glfw_error_callback);
         if (!glfwInit())
             return 1;
+        startup.Mark(StartupStage::Platform);
 
             // Decide GL+GLSL versions
 #if __APPLE__
@@ -179,6 +979,8 @@ namespace
         glfwSetWindowPos(window, window_config.pos_x, window_config.pos_y);
         glfwMakeContextCurrent(window);
         glfwSwapInterval(1); // Enable vsync
+        InstallEventCallbacks(window);
+        startup.Mark(StartupStage::Window);
 
         // Initialize OpenGL loader
 #if defined(IMGUI_IMPL_OPENGL_LOADER_GL3W)
@@ -188,9 +990,10 @@ namespace
 #elif defined(IMGUI_IMPL_OPENGL_LOADER_GLAD)
         bool err = gladLoadGL() == 0;
 #elif defined(IMGUI_IMPL_OPENGL_LOADER_GLAD2)
-        bool err =
-            gladLoadGL(glfwGetProcAddress) == 0; // glad2 recommend using the windowing library
-                                                 // loader instead of the (optionally) bundled one.
+        // glad2 recommend using the windowing library loader instead of the (optionally) bundled
+        // one.
+        bool err = (app.RenderingConfig().lazy_gl_loading ? LoadGLLazy(glfwGetProcAddress)
+                                                          : gladLoadGL(glfwGetProcAddress)) == 0;
 #elif defined(IMGUI_IMPL_OPENGL_LOADER_GLBINDING2)
         bool err = false;
         glbinding::Binding::initialize();
@@ -207,6 +1010,8 @@ namespace
             fprintf(stderr, "Failed to initialize OpenGL loader!\n");
             return 1;
         }
+        GlExt().Load(glfwGetProcAddress);
+        startup.Mark(StartupStage::GlLoader);
 
         // Setup Dear ImGui context
         IMGUI_CHECKVERSION();
@@ -222,7 +1027,8 @@ namespace
 
         // Setup Platform/Renderer bindings
         ImGui_ImplGlfw_InitForOpenGL(window, true);
-        ImGui_ImplOpenGL3_Init(glsl_version);
+        Renderer_Gl3::Init(glsl_version, []() -> void* { return glfwGetCurrentContext(); });
+        startup.Mark(StartupStage::Context);
 
         // Load Fonts
         // - If no fonts are loaded, dear imgui will use the default font. You can also load
@@ -245,9 +1051,73 @@ namespace
         // NULL, io.Fonts->GetGlyphRangesJapanese()); IM_ASSERT(font != NULL);
 
         // Main loop
-        CurrentWindow = std::make_unique<PlatformWindow_Glfw>(window);
+        CurrentWindow       = std::make_unique<PlatformWindow_Glfw>(window);
+        MainContext         = ImGui::GetCurrentContext();
+        SharedContextWindow = window;
         app.Initialize();
+        startup.Mark(StartupStage::AppInit);
+
+        // Build the font atlas after Initialize(), so that fonts added there are included, or load
+        // it from the on-disk cache
+        PrepareDynamicFonts(*io.Fonts);
+        BuildFontAtlas(app, *io.Fonts);
+        startup.Mark(StartupStage::FontAtlas);
+
+        // Link the renderer's program, or load it from the on-disk cache, and upload the atlas
+        Renderer_Gl3::SetProgramCacheDir(app.RenderingConfig().program_cache_dir);
+        Renderer_Gl3::CreateDeviceObjects();
+        app.RecordProgram(Renderer_Gl3::ProgramCached());
+
+        // Dynamic fonts draw from a texture of their own that grows as glyphs are rasterized,
+        // replacing the one the renderer just created from the atlas
+        if (HasDynamicFonts())
+        {
+            Renderer_Gl3::DestroyFontsTexture();
+            if (!AttachDynamicFonts(*io.Fonts))
+            {
+                Renderer_Gl3::CreateFontsTexture();
+            }
+        }
+        startup.Mark(StartupStage::Renderer);
+
+        // Hand the window's context over to the render thread, the main thread keeps a hidden
+        // context sharing textures and buffers with it for uploads
+        RenderThread render_thread;
+        PartialRenderer partial_renderer;
+        GLFWwindow* upload_window = NULL;
+        bool pipelined            = app.RenderingConfig().pipelined;
+        if (pipelined)
+        {
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            upload_window = glfwCreateWindow(1, 1, "", NULL, window);
+            glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+            if (upload_window == NULL)
+            {
+                fprintf(stderr, "Failed to create upload context, pipelining is disabled!\n");
+                pipelined = false;
+            }
+            else
+            {
+#if defined(IMGUI_IMPL_OPENGL_LOADER_GLAD2)
+                // Functions resolved lazily replace themselves on the first call, which must not
+                // race between the two threads
+                GlLazy::ResolveAll();
+#endif
+                glfwMakeContextCurrent(upload_window);
+                render_thread.Start(window, app.RenderingConfig().partial_redraw);
+
+                // the window's context is now current on the render thread
+                SharedContextWindow = upload_window;
+            }
+        }
 
+        int refresh_rate        = QueryRefreshRate(window);
+        int pending_frames      = kFramesAfterEvent;
+        double last_swap_time   = glfwGetTime();
+        uint64_t presented_hash = 0;
+        FrameTimer timer;
+        MainLoopRunning = true;
         while (!glfwWindowShouldClose(window))
         {
             // Poll and handle events (inputs, window resize, etc.)
@@ -258,34 +1128,174 @@ namespace
             // - When io.WantCaptureKeyboard is true, do not dispatch keyboard input data to your
             // main application. Generally you may always pass all inputs to dear imgui, and hide
             // them from your application based on those two flags.
-            glfwPollEvents();
+            if (!ProcessEvents(app, pending_frames, timer))
+            {
+                continue;
+            }
+            timer.Mark(FramePhase::Events);
+
+            // Account for the vsync intervals we slept through in on-demand mode
+            double frame_begin_time = glfwGetTime();
+            app.RecordSkippedFrames(
+                static_cast<uint64_t>((frame_begin_time - last_swap_time) * refresh_rate));
 
             // Start the Dear ImGui frame
-            ImGui_ImplOpenGL3_NewFrame();
+            Renderer_Gl3::NewFrame();
             ImGui_ImplGlfw_NewFrame();
             ImGui::NewFrame();
+            timer.Mark(FramePhase::NewFrame);
 
             // Update application state
             app.Update();
+            if (app.RenderingConfig().show_frame_stats)
+            {
+                ImGui::ShowFrameStatsOverlay(app.FrameStats(), app.FrameCounters());
+            }
+            timer.Mark(FramePhase::Update);
 
             // Rendering
             ImVec4 clear_color = app.RenderingConfig().bg_color;
 
             ImGui::Render();
+            BuildSecondaryFrames();
+
+            // Account the textures of all windows on the main context, whose frame count is the
+            // one TextureMemory and the dynamic fonts follow
+            TextureMemory::Get().Update(ImGui::GetDrawData());
+            bool glyphs_added = UpdateDynamicFonts(ImGui::GetDrawData());
+            for (SecondaryWindow_Glfw* secondary : SecondaryWindows)
+            {
+                if (secondary->DrawData() != nullptr)
+                {
+                    TextureMemory::Get().Update(secondary->DrawData());
+                    glyphs_added |= UpdateDynamicFonts(secondary->DrawData());
+                }
+            }
+            if (glyphs_added)
+            {
+                app.RequestRedraw();
+            }
+            timer.Mark(FramePhase::Render);
+
+            // The other windows are presented first, the main window's swap then waits for vsync
+            // once for all of them
+            RenderSecondaryFrames(clear_color);
+
             int display_w, display_h;
             glfwGetFramebufferSize(window, &display_w, &display_h);
-            glViewport(0, 0, display_w, display_h);
-            glClearColor(clear_color.x, clear_color.y, clear_color.z, clear_color.w);
-            glClear(GL_COLOR_BUFFER_BIT);
-            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
-            glfwSwapBuffers(window);
+            // Compare against the last presented frame, texture uploads invalidate it as well
+            uint64_t frame_hash = 0;
+            if (app.RenderingConfig().skip_identical_frames)
+            {
+                const uint64_t frame_state[] = {
+                    static_cast<uint64_t>(display_w), static_cast<uint64_t>(display_h),
+                    PlatformTexture_Gl3::Stats().uploads};
+                uint64_t seed = HashBytes(&clear_color, sizeof(clear_color));
+                seed          = HashBytes(frame_state, sizeof(frame_state), seed);
+                frame_hash    = HashDrawData(ImGui::GetDrawData(), seed);
+            }
+
+            if (frame_hash != 0 && frame_hash == presented_hash && !WindowDamaged)
+            {
+                timer.Mark(FramePhase::Submit);
+
+                // There is no swap to block on, keep pacing the loop at the display rate
+                double remaining = 1. / refresh_rate - (glfwGetTime() - last_swap_time);
+                if (remaining > 0)
+                {
+                    glfwWaitEventsTimeout(remaining);
+                }
+                timer.Mark(FramePhase::Present);
+
+                last_swap_time = glfwGetTime();
+                app.RecordIdenticalFrame();
+            }
+            else
+            {
+                if (pipelined)
+                {
+                    // Present is the time spent waiting for the render thread to take the
+                    // previous frame, Submit is the time to snapshot this one
+                    render_thread.WaitForSlot();
+                    timer.Mark(FramePhase::Present);
+
+                    render_thread.Submit(ImGui::GetDrawData(), display_w, display_h, clear_color);
+                    timer.Mark(FramePhase::Submit);
+                }
+                else if (app.RenderingConfig().partial_redraw)
+                {
+                    partial_renderer.Render(ImGui::GetDrawData(), display_w, display_h,
+                                            clear_color, PlatformTexture_Gl3::Stats().uploads);
+                    timer.Mark(FramePhase::Submit);
+
+                    partial_renderer.Present(window);
+                    timer.Mark(FramePhase::Present);
+                }
+                else
+                {
+                    partial_renderer.Invalidate();
+
+                    glViewport(0, 0, display_w, display_h);
+                    glClearColor(clear_color.x, clear_color.y, clear_color.z, clear_color.w);
+                    glClear(GL_COLOR_BUFFER_BIT);
+                    Renderer_Gl3::RenderDrawData(ImGui::GetDrawData());
+                    timer.Mark(FramePhase::Submit);
+
+                    glfwSwapBuffers(window);
+                    timer.Mark(FramePhase::Present);
+                }
+
+                presented_hash = frame_hash;
+                WindowDamaged  = false;
+
+                last_swap_time = glfwGetTime();
+                app.RecordRenderedFrame();
+
+                if (app.FrameCounters().rendered_frames == 1)
+                {
+                    startup.Mark(StartupStage::FirstFrame);
+                    app.RecordStartup(startup);
+                    if (app.RenderingConfig().trace_startup)
+                    {
+                        PrintStartupTrace(stderr, "GLFW:", app.StartupStats());
+                    }
+                }
+            }
+            app.RecordFrameTiming(timer);
+
+            // Keep drawing while the user interacts with a widget, e.g. dragging a slider
+            if (ImGui::IsAnyItemActive())
+            {
+                pending_frames = std::max(pending_frames, 1);
+            }
         }
 
         // Cleanup
-        ImGui_ImplOpenGL3_Shutdown();
+        MainLoopRunning = false;
+        if (pipelined)
+        {
+            render_thread.Stop();
+            Renderer_Gl3::ReleaseContext();
+            glfwMakeContextCurrent(window);
+            glfwDestroyWindow(upload_window);
+        }
+        for (SecondaryWindow_Glfw* secondary : SecondaryWindows)
+        {
+            if (secondary != nullptr)
+            {
+                secondary->Destroy();
+            }
+        }
+        SecondaryWindows.clear();
+        SharedContextWindow = NULL;
+        partial_renderer.Cleanup();
+        CleanupDynamicFonts();
+        PlatformTexture_Gl3::ClearPool();
+        Renderer_Gl3::Shutdown();
         ImGui_ImplGlfw_Shutdown();
         ImGui::DestroyContext();
+        MainContext = nullptr;
 
         glfwDestroyWindow(window);
         glfwTerminate();
@@ -296,15 +1306,90 @@ namespace
 
 } // namespace
 
+void WakeMainLoop()
+{
+    if (MainLoopRunning)
+    {
+        glfwPostEmptyEvent();
+    }
+}
+
 PlatformWindow& GetCurrentWindow()
 {
-    return *CurrentWindow;
+    return ActiveWindow != nullptr ? *ActiveWindow : *CurrentWindow;
 }
 
-std::unique_ptr<PlatformTexture> AllocateTexture(int width, int height)
+std::unique_ptr<PlatformWindow> OpenWindow(const AppWindowConfig& config,
+                                           std::function<void()> draw)
+{
+    if (SharedContextWindow == NULL)
+    {
+        return nullptr;
+    }
+
+    // GLFW creates a GL context per window, sharing textures and buffers with the main one
+    GLFWwindow* window = glfwCreateWindow(config.width, config.height, config.title.c_str(), NULL,
+                                          SharedContextWindow);
+    if (window == NULL)
+    {
+        fprintf(stderr, "Failed to open window %s!\n", config.title.c_str());
+        return nullptr;
+    }
+    glfwSetWindowPos(window, config.pos_x, config.pos_y);
+
+    // only the main window's swap waits for vsync, see RenderSecondaryFrames()
+    GLFWwindow* current = glfwGetCurrentContext();
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+    glfwMakeContextCurrent(current);
+
+    // the new imgui context draws with the main one's font atlas and takes over its settings
+    ImGuiContext* previous = ImGui::GetCurrentContext();
+    ImGui::SetCurrentContext(MainContext);
+    ImGuiIO& main_io       = ImGui::GetIO();
+    ImGuiStyle& main_style = ImGui::GetStyle();
+    ImGuiContext* context  = ImGui::CreateContext(main_io.Fonts);
+    ImGui::SetCurrentContext(context);
+
+    ImGuiIO& io            = ImGui::GetIO();
+    io.IniFilename         = nullptr; // imgui.ini keeps the main window's layout
+    io.ConfigFlags         = main_io.ConfigFlags;
+    io.BackendPlatformName = main_io.BackendPlatformName;
+    io.BackendRendererName = main_io.BackendRendererName;
+    io.GetClipboardTextFn  = main_io.GetClipboardTextFn;
+    io.SetClipboardTextFn  = main_io.SetClipboardTextFn;
+    io.ClipboardUserData   = main_io.ClipboardUserData;
+    std::copy(std::begin(main_io.KeyMap), std::end(main_io.KeyMap), io.KeyMap);
+    ImGui::GetStyle() = main_style;
+    ImGui::SetCurrentContext(previous);
+
+    return std::make_unique<SecondaryWindow_Glfw>(window, context, std::move(draw));
+}
+
+const PlatformTextureStats& GetTextureStats()
+{
+    return PlatformTexture_Gl3::Stats();
+}
+
+const TextureMemoryStats& GetTextureMemoryStats()
+{
+    return TextureMemory::Get().Stats();
+}
+
+void SetTextureMemoryBudget(size_t bytes)
+{
+    TextureMemory::Get().SetBudget(bytes);
+}
+
+void SetTexturePoolCapacity(size_t bytes)
+{
+    PlatformTexture_Gl3::SetPoolCapacity(bytes);
+}
+
+std::unique_ptr<PlatformTexture> AllocateTexture(int width, int height, TextureFormat format)
 {
     auto result = std::make_unique<PlatformTexture_Gl3>();
-    if (!result->Initialize(width, height))
+    if (!result->Initialize(width, height, format))
     {
         return nullptr;
     }
@@ -312,6 +1397,17 @@ std::unique_ptr<PlatformTexture> AllocateTexture(int width, int height)
     return result;
 }
 
+bool RenderToTexture(PlatformTexture& texture, ImDrawData* draw_data, ImVec4 clear_color)
+{
+    if (!Renderer_Gl3::RenderToTexture(texture.Id(), draw_data, clear_color))
+    {
+        return false;
+    }
+
+    PlatformTexture_Gl3::CountRender();
+    return true;
+}
+
 int RunApplication(Application& app, AppWindowConfig window_config)
 {
     return DoMain_GL3_GLFW(app, window_config);
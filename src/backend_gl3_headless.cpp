@@ -0,0 +1,408 @@
+// renders into an offscreen framebuffer on a surfaceless EGL context, intended for CI and
+// benchmarking on machines without a display (e.g. Mesa llvmpipe)
+
+#define GLAD_GL_IMPLEMENTATION 1
+
+#include "imgui.h"
+
+#include "application.h"
+#include "platform.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// Include EGL before glad, whose bundled khrplatform.h lacks the definitions EGL needs
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <glad/gl.h>
+
+#include "dynamic_font_atlas.h"
+#include "font_atlas_cache.h"
+#include "gl_ext.h"
+#include "gl_lazy_loader.h"
+#include "offscreen_window.h"
+#include "renderer_gl3.h"
+#include "texture_gl3.h"
+#include "texture_memory.h"
+
+namespace
+{
+    class PlatformWindow_Headless final : public PlatformWindow_Offscreen
+    {
+    private:
+        GLuint fbo_    = 0;
+        GLuint color_  = 0;
+        int fb_width_  = 0;
+        int fb_height_ = 0;
+
+    public:
+        using PlatformWindow_Offscreen::PlatformWindow_Offscreen;
+
+        ~PlatformWindow_Headless()
+        {
+            DestroyFramebuffer();
+        }
+
+        // bind the offscreen render target, (re)creating it if the window has been resized
+        bool BindFramebuffer()
+        {
+            auto [width, height] = GetSize();
+            if (fbo_ == 0 || fb_width_ != width || fb_height_ != height)
+            {
+                DestroyFramebuffer();
+
+                glGenRenderbuffers(1, &color_);
+                glBindRenderbuffer(GL_RENDERBUFFER, color_);
+                glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+                glGenFramebuffers(1, &fbo_);
+                glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+                glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER,
+                                          color_);
+
+                if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+                {
+                    DestroyFramebuffer();
+                    return false;
+                }
+
+                fb_width_  = width;
+                fb_height_ = height;
+            }
+
+            glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+            return true;
+        }
+
+        // read back the framebuffer with the top row first
+        void ReadPixels(std::vector<uint8_t>& out)
+        {
+            size_t pitch = static_cast<size_t>(fb_width_) * 4;
+            out.resize(pitch * fb_height_);
+
+            glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            glReadPixels(0, 0, fb_width_, fb_height_, GL_RGBA, GL_UNSIGNED_BYTE, out.data());
+
+            for (int y = 0; y < fb_height_ / 2; ++y)
+            {
+                std::swap_ranges(out.begin() + y * pitch, out.begin() + (y + 1) * pitch,
+                                 out.begin() + (fb_height_ - 1 - y) * pitch);
+            }
+        }
+
+        void DestroyFramebuffer()
+        {
+            if (fbo_ != 0)
+            {
+                glDeleteFramebuffers(1, &fbo_);
+                fbo_ = 0;
+            }
+            if (color_ != 0)
+            {
+                glDeleteRenderbuffers(1, &color_);
+                color_ = 0;
+            }
+
+            fb_width_  = 0;
+            fb_height_ = 0;
+        }
+    };
+
+    static std::unique_ptr<PlatformWindow_Headless> CurrentWindow = nullptr;
+
+    EGLDisplay OpenDisplay()
+    {
+        // Prefer Mesa's surfaceless platform, which needs neither a window system nor a GPU
+        const char* client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+        auto get_platform_display     = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+        EGLDisplay display = EGL_NO_DISPLAY;
+        if (get_platform_display != nullptr && client_extensions != nullptr &&
+            strstr(client_extensions, "EGL_MESA_platform_surfaceless") != nullptr)
+        {
+            display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY,
+                                           nullptr);
+        }
+        if (display == EGL_NO_DISPLAY)
+        {
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        }
+
+        return display;
+    }
+
+    EGLContext CreateContext(EGLDisplay display)
+    {
+        const EGLint config_attribs[] = {EGL_SURFACE_TYPE,
+                                         EGL_PBUFFER_BIT,
+                                         EGL_RENDERABLE_TYPE,
+                                         EGL_OPENGL_BIT,
+                                         EGL_RED_SIZE,
+                                         8,
+                                         EGL_GREEN_SIZE,
+                                         8,
+                                         EGL_BLUE_SIZE,
+                                         8,
+                                         EGL_ALPHA_SIZE,
+                                         8,
+                                         EGL_NONE};
+
+        EGLConfig config;
+        EGLint num_configs = 0;
+        if (!eglChooseConfig(display, config_attribs, &config, 1, &num_configs) ||
+            num_configs == 0)
+        {
+            return EGL_NO_CONTEXT;
+        }
+
+        // GL 3.0, matching "#version 130" below
+        const EGLint context_attribs[] = {EGL_CONTEXT_MAJOR_VERSION, 3,
+                                          EGL_CONTEXT_MINOR_VERSION, 0, EGL_NONE};
+
+        eglBindAPI(EGL_OPENGL_API);
+        return eglCreateContext(display, config, EGL_NO_CONTEXT, context_attribs);
+    }
+
+    int DoMain_GL3_Headless(Application& app, const AppWindowConfig& window_config)
+    {
+        StartupTimer startup;
+
+        // Setup EGL context without any surface
+        EGLDisplay display = OpenDisplay();
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr))
+        {
+            fprintf(stderr, "Failed to initialize EGL display!\n");
+            return 1;
+        }
+
+        const char* display_extensions = eglQueryString(display, EGL_EXTENSIONS);
+        if (display_extensions == nullptr ||
+            strstr(display_extensions, "EGL_KHR_surfaceless_context") == nullptr)
+        {
+            fprintf(stderr, "EGL_KHR_surfaceless_context is not supported!\n");
+            eglTerminate(display);
+            return 1;
+        }
+
+        startup.Mark(StartupStage::Platform);
+
+        EGLContext context = CreateContext(display);
+        if (context == EGL_NO_CONTEXT ||
+            !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+        {
+            fprintf(stderr, "Failed to create EGL context!\n");
+            eglTerminate(display);
+            return 1;
+        }
+
+        startup.Mark(StartupStage::Window);
+
+        // Initialize OpenGL loader
+        auto load = reinterpret_cast<GLADloadfunc>(eglGetProcAddress);
+        if ((app.RenderingConfig().lazy_gl_loading ? LoadGLLazy(load) : gladLoadGL(load)) == 0)
+        {
+            fprintf(stderr, "Failed to initialize OpenGL loader!\n");
+            eglDestroyContext(display, context);
+            eglTerminate(display);
+            return 1;
+        }
+        GlExt().Load(eglGetProcAddress);
+        startup.Mark(StartupStage::GlLoader);
+
+        // Setup Dear ImGui context
+        IMGUI_CHECKVERSION();
+        ImGui::CreateContext();
+        ImGuiIO& io    = ImGui::GetIO();
+        io.IniFilename = nullptr; // Keep runs reproducible
+
+        // Setup Dear ImGui style
+        ImGui::StyleColorsDark();
+
+        // Setup Renderer bindings
+        Renderer_Gl3::Init("#version 130");
+        startup.Mark(StartupStage::Context);
+
+        // Main loop
+        CurrentWindow = std::make_unique<PlatformWindow_Headless>(window_config);
+        app.Initialize();
+        startup.Mark(StartupStage::AppInit);
+
+        // Build the font atlas after Initialize(), so that fonts added there are included, or load
+        // it from the on-disk cache
+        PrepareDynamicFonts(*io.Fonts);
+        BuildFontAtlas(app, *io.Fonts);
+        startup.Mark(StartupStage::FontAtlas);
+
+        // Link the renderer's program, or load it from the on-disk cache, and upload the atlas
+        Renderer_Gl3::SetProgramCacheDir(app.RenderingConfig().program_cache_dir);
+        Renderer_Gl3::CreateDeviceObjects();
+        app.RecordProgram(Renderer_Gl3::ProgramCached());
+
+        // Dynamic fonts draw from a texture of their own that grows as glyphs are rasterized,
+        // replacing the one the renderer just created from the atlas
+        if (HasDynamicFonts())
+        {
+            Renderer_Gl3::DestroyFontsTexture();
+            if (!AttachDynamicFonts(*io.Fonts))
+            {
+                Renderer_Gl3::CreateFontsTexture();
+            }
+        }
+        startup.Mark(StartupStage::Renderer);
+
+        const AppHeadlessConfig& headless = app.HeadlessConfig();
+
+        int result = 0;
+        std::vector<uint8_t> readback;
+        FrameTimer timer;
+        for (int frame = 0; frame < headless.frame_count; ++frame)
+        {
+            timer.Begin();
+            if (!CurrentWindow->BindFramebuffer())
+            {
+                fprintf(stderr, "Failed to create offscreen framebuffer!\n");
+                result = 1;
+                break;
+            }
+
+            // Synthetic platform state
+            auto [display_w, display_h] = CurrentWindow->GetSize();
+            io.DisplaySize = ImVec2(static_cast<float>(display_w), static_cast<float>(display_h));
+            io.DeltaTime   = static_cast<float>(headless.delta_time);
+            if (headless.synthetic_input)
+            {
+                FeedSyntheticInput(io, frame);
+            }
+            timer.Mark(FramePhase::Events);
+
+            // Start the Dear ImGui frame
+            Renderer_Gl3::NewFrame();
+            ImGui::NewFrame();
+            timer.Mark(FramePhase::NewFrame);
+
+            // Update application state
+            app.Update();
+            if (app.RenderingConfig().show_frame_stats)
+            {
+                ImGui::ShowFrameStatsOverlay(app.FrameStats(), app.FrameCounters());
+            }
+            timer.Mark(FramePhase::Update);
+
+            // Rendering
+            ImVec4 clear_color = app.RenderingConfig().bg_color;
+
+            ImGui::Render();
+            TextureMemory::Get().Update(ImGui::GetDrawData());
+            UpdateDynamicFonts(ImGui::GetDrawData());
+            timer.Mark(FramePhase::Render);
+
+            glViewport(0, 0, display_w, display_h);
+            glClearColor(clear_color.x, clear_color.y, clear_color.z, clear_color.w);
+            glClear(GL_COLOR_BUFFER_BIT);
+            Renderer_Gl3::RenderDrawData(ImGui::GetDrawData());
+            timer.Mark(FramePhase::Submit);
+
+            // There is no swap chain to throttle us, wait for the GPU so frame times are honest
+            glFinish();
+            timer.Mark(FramePhase::Present);
+
+            app.RecordRenderedFrame();
+            app.RecordFrameTiming(timer);
+            if (frame == 0)
+            {
+                startup.Mark(StartupStage::FirstFrame);
+                app.RecordStartup(startup);
+                if (app.RenderingConfig().trace_startup)
+                {
+                    PrintStartupTrace(stderr, "Headless:", app.StartupStats());
+                }
+            }
+
+            if (headless.on_frame)
+            {
+                CurrentWindow->ReadPixels(readback);
+                headless.on_frame(readback.data(), display_w, display_h, display_w * 4);
+            }
+        }
+
+        // Cleanup
+        CleanupDynamicFonts();
+        PlatformTexture_Gl3::ClearPool();
+        Renderer_Gl3::Shutdown();
+        ImGui::DestroyContext();
+
+        CurrentWindow = nullptr;
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display, context);
+        eglTerminate(display);
+
+        return result;
+    }
+
+} // namespace
+
+void WakeMainLoop()
+{
+    // the headless loop never blocks
+}
+
+PlatformWindow& GetCurrentWindow()
+{
+    return *CurrentWindow;
+}
+
+// NOTE the headless backend has a single window
+std::unique_ptr<PlatformWindow> OpenWindow(const AppWindowConfig&, std::function<void()>)
+{
+    return nullptr;
+}
+
+const PlatformTextureStats& GetTextureStats()
+{
+    return PlatformTexture_Gl3::Stats();
+}
+
+const TextureMemoryStats& GetTextureMemoryStats()
+{
+    return TextureMemory::Get().Stats();
+}
+
+void SetTextureMemoryBudget(size_t bytes)
+{
+    TextureMemory::Get().SetBudget(bytes);
+}
+
+void SetTexturePoolCapacity(size_t bytes)
+{
+    PlatformTexture_Gl3::SetPoolCapacity(bytes);
+}
+
+std::unique_ptr<PlatformTexture> AllocateTexture(int width, int height, TextureFormat format)
+{
+    auto result = std::make_unique<PlatformTexture_Gl3>();
+    if (!result->Initialize(width, height, format))
+    {
+        return nullptr;
+    }
+
+    return result;
+}
+
+bool RenderToTexture(PlatformTexture& texture, ImDrawData* draw_data, ImVec4 clear_color)
+{
+    if (!Renderer_Gl3::RenderToTexture(texture.Id(), draw_data, clear_color))
+    {
+        return false;
+    }
+
+    PlatformTexture_Gl3::CountRender();
+    return true;
+}
+
+int RunApplication(Application& app, AppWindowConfig window_config)
+{
+    return DoMain_GL3_Headless(app, window_config);
+}
@@ -0,0 +1,364 @@
+// renders on the CPU into an in-memory framebuffer, for machines without any OpenGL
+
+#include "imgui.h"
+
+#include "application.h"
+#include "font_atlas_cache.h"
+#include "offscreen_window.h"
+#include "platform.h"
+#include "software_rasterizer.h"
+#include "texture_memory.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    static PlatformTextureStats TextureStats;
+
+    float HalfToFloat(uint16_t h)
+    {
+        uint32_t sign     = (h >> 15) & 1;
+        uint32_t exponent = (h >> 10) & 0x1F;
+        uint32_t mantissa = h & 0x3FF;
+
+        float magnitude;
+        if (exponent == 0)
+        {
+            magnitude = ldexpf(static_cast<float>(mantissa), -24);
+        }
+        else if (exponent == 31)
+        {
+            magnitude = mantissa == 0 ? INFINITY : NAN;
+        }
+        else
+        {
+            int exp2  = static_cast<int>(exponent) - 25;
+            magnitude = ldexpf(static_cast<float>(mantissa | 0x400), exp2);
+        }
+
+        return sign ? -magnitude : magnitude;
+    }
+
+    // expand one pixel to RGBA8, with the same grayscale mapping as the GPU backends' swizzles
+    uint32_t ToRgba(TextureFormat format, const uint8_t* p)
+    {
+        auto gray = [](uint32_t l, uint32_t a) { return l | (l << 8) | (l << 16) | (a << 24); };
+        auto unorm = [](float x) {
+            return static_cast<uint32_t>(std::clamp(x, 0.f, 1.f) * 255.f + 0.5f);
+        };
+
+        switch (format)
+        {
+        case TextureFormat::Bgra8:
+            return p[2] | (p[1] << 8) | (p[0] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        case TextureFormat::R8:
+            return gray(p[0], 0xFF);
+        case TextureFormat::Rg8:
+            return gray(p[0], p[1]);
+        case TextureFormat::R16F:
+        {
+            uint16_t h;
+            memcpy(&h, p, sizeof(h));
+            return gray(unorm(HalfToFloat(h)), 0xFF);
+        }
+        case TextureFormat::R32F:
+        {
+            float f;
+            memcpy(&f, p, sizeof(f));
+            return gray(unorm(f), 0xFF);
+        }
+        case TextureFormat::Rgb565:
+        {
+            uint16_t v;
+            memcpy(&v, p, sizeof(v));
+            uint32_t r = ((v >> 11) & 0x1F) * 255 / 31;
+            uint32_t g = ((v >> 5) & 0x3F) * 255 / 63;
+            uint32_t b = (v & 0x1F) * 255 / 31;
+            return r | (g << 8) | (b << 16) | 0xFF000000u;
+        }
+        default:
+        {
+            uint32_t rgba;
+            memcpy(&rgba, p, sizeof(rgba));
+            return rgba;
+        }
+        }
+    }
+
+    class PlatformTexture_Software final : public PlatformTexture
+    {
+    private:
+        SoftwareTexture tex_;
+
+    public:
+        PlatformTexture_Software() = default;
+        ~PlatformTexture_Software() override
+        {
+            Cleanup();
+        }
+
+        // NOTE pixels are always stored as RGBA8, other formats are converted on upload
+        bool Initialize(int width, int height, TextureFormat format)
+        {
+            tex_.width  = width;
+            tex_.height = height;
+            tex_.pixels.assign(static_cast<size_t>(width) * height, 0);
+
+            width_  = width;
+            height_ = height;
+            format_ = format;
+            id_     = &tex_;
+            TextureMemory::Get().Track(this, tex_.pixels.size() * sizeof(uint32_t));
+            return true;
+        }
+
+        virtual void UpdateRgba(const void* p) override
+        {
+            IM_ASSERT(Format() == TextureFormat::Rgba8 && "use UpdatePixels() for other formats");
+            UpdatePixels(p);
+        }
+
+        virtual void UpdateRegion(int x, int y, int width, int height, const void* p,
+                                  int row_stride) override
+        {
+            IM_ASSERT(x >= 0 && y >= 0 && x + width <= width_ && y + height <= height_);
+            TextureMemory::Get().Restore(*this);
+
+            int bytes_per_pixel = BytesPerPixel(format_);
+            for (int row = 0; row < height; ++row)
+            {
+                uint32_t* dst = &tex_.pixels[static_cast<size_t>(y + row) * tex_.width + x];
+                const uint8_t* src =
+                    static_cast<const uint8_t*>(p) + static_cast<size_t>(row) * row_stride;
+                if (format_ == TextureFormat::Rgba8)
+                {
+                    memcpy(dst, src, static_cast<size_t>(width) * sizeof(uint32_t));
+                    continue;
+                }
+
+                for (int i = 0; i < width; ++i)
+                {
+                    dst[i] = ToRgba(format_, src + i * bytes_per_pixel);
+                }
+            }
+            TextureStats.uploads += 1;
+        }
+
+        virtual void Update(std::function<void(void* p, int row_pitch)> f) override
+        {
+            TextureMemory::Get().Restore(*this);
+            if (format_ == TextureFormat::Rgba8)
+            {
+                f(tex_.pixels.data(), tex_.width * 4);
+                TextureStats.uploads += 1;
+                return;
+            }
+
+            int row_pitch = width_ * BytesPerPixel(format_);
+            std::vector<uint8_t> pixels(static_cast<size_t>(row_pitch) * height_);
+            f(pixels.data(), row_pitch);
+            UpdateRegion(0, 0, width_, height_, pixels.data(), row_pitch);
+        }
+
+        void Cleanup()
+        {
+            TextureMemory::Get().Untrack(this);
+            tex_ = {};
+
+            Clear();
+        }
+
+    protected:
+        virtual bool EvictStorage() override
+        {
+            tex_.pixels = {};
+            return true;
+        }
+
+        virtual void RestoreStorage() override
+        {
+            tex_.pixels.assign(static_cast<size_t>(tex_.width) * tex_.height, 0);
+        }
+    };
+
+    static std::unique_ptr<PlatformWindow_Offscreen> CurrentWindow = nullptr;
+
+    int DoMain_Software(Application& app, const AppWindowConfig& window_config)
+    {
+        StartupTimer startup;
+
+        // Setup Dear ImGui context
+        IMGUI_CHECKVERSION();
+        ImGui::CreateContext();
+        ImGuiIO& io            = ImGui::GetIO();
+        io.IniFilename         = nullptr; // Keep runs reproducible
+        io.BackendRendererName = "quick_imgui_software";
+
+        // The rasterizer honors ImDrawCmd::VtxOffset, allowing large meshes with 16-bit indices
+        io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+
+        // Setup Dear ImGui style
+        ImGui::StyleColorsDark();
+        startup.Mark(StartupStage::Context);
+
+        // Main loop
+        CurrentWindow = std::make_unique<PlatformWindow_Offscreen>(window_config);
+        startup.Mark(StartupStage::Window);
+        app.Initialize();
+        startup.Mark(StartupStage::AppInit);
+
+        // Build the font atlas after Initialize(), so that fonts added there are included, or load
+        // it from the on-disk cache
+        BuildFontAtlas(app, *io.Fonts);
+
+        unsigned char* font_pixels;
+        int font_width, font_height;
+        io.Fonts->GetTexDataAsRGBA32(&font_pixels, &font_width, &font_height);
+
+        auto font_texture = AllocateTexture(font_width, font_height);
+        font_texture->UpdateRgba(font_pixels);
+        io.Fonts->TexID = font_texture->Id();
+        startup.Mark(StartupStage::FontAtlas);
+
+        const AppHeadlessConfig& headless = app.HeadlessConfig();
+
+        SoftwareRasterizer rasterizer;
+        FrameTimer timer;
+        for (int frame = 0; frame < headless.frame_count; ++frame)
+        {
+            timer.Begin();
+
+            // Synthetic platform state
+            auto [display_w, display_h] = CurrentWindow->GetSize();
+            io.DisplaySize = ImVec2(static_cast<float>(display_w), static_cast<float>(display_h));
+            io.DeltaTime   = static_cast<float>(headless.delta_time);
+            if (headless.synthetic_input)
+            {
+                FeedSyntheticInput(io, frame);
+            }
+            timer.Mark(FramePhase::Events);
+
+            // Start the Dear ImGui frame
+            ImGui::NewFrame();
+            timer.Mark(FramePhase::NewFrame);
+
+            // Update application state
+            app.Update();
+            if (app.RenderingConfig().show_frame_stats)
+            {
+                ImGui::ShowFrameStatsOverlay(app.FrameStats(), app.FrameCounters());
+            }
+            timer.Mark(FramePhase::Update);
+
+            // Rendering
+            ImGui::Render();
+            TextureMemory::Get().Update(ImGui::GetDrawData());
+            timer.Mark(FramePhase::Render);
+
+            rasterizer.Resize(display_w, display_h);
+            rasterizer.Clear(app.RenderingConfig().bg_color);
+            rasterizer.RenderDrawData(ImGui::GetDrawData());
+            timer.Mark(FramePhase::Submit);
+
+            app.RecordRenderedFrame();
+            app.RecordFrameTiming(timer);
+            if (frame == 0)
+            {
+                startup.Mark(StartupStage::FirstFrame);
+                app.RecordStartup(startup);
+                if (app.RenderingConfig().trace_startup)
+                {
+                    PrintStartupTrace(stderr, "Software:", app.StartupStats());
+                }
+            }
+
+            if (headless.on_frame)
+            {
+                headless.on_frame(rasterizer.Pixels(), rasterizer.Width(), rasterizer.Height(),
+                                  rasterizer.Stride() * 4);
+            }
+        }
+
+        // Cleanup
+        io.Fonts->TexID = nullptr;
+        font_texture    = nullptr;
+        ImGui::DestroyContext();
+
+        CurrentWindow = nullptr;
+
+        return 0;
+    }
+
+} // namespace
+
+void WakeMainLoop()
+{
+    // the software loop never blocks
+}
+
+PlatformWindow& GetCurrentWindow()
+{
+    return *CurrentWindow;
+}
+
+// NOTE the software backend has a single window
+std::unique_ptr<PlatformWindow> OpenWindow(const AppWindowConfig&, std::function<void()>)
+{
+    return nullptr;
+}
+
+const PlatformTextureStats& GetTextureStats()
+{
+    return TextureStats;
+}
+
+const TextureMemoryStats& GetTextureMemoryStats()
+{
+    return TextureMemory::Get().Stats();
+}
+
+void SetTextureMemoryBudget(size_t bytes)
+{
+    TextureMemory::Get().SetBudget(bytes);
+}
+
+void SetTexturePoolCapacity(size_t)
+{
+    // textures are plain memory here, there is no driver allocation to save
+}
+
+std::unique_ptr<PlatformTexture> AllocateTexture(int width, int height, TextureFormat format)
+{
+    auto result = std::make_unique<PlatformTexture_Software>();
+    if (!result->Initialize(width, height, format))
+    {
+        return nullptr;
+    }
+
+    return result;
+}
+
+bool RenderToTexture(PlatformTexture& texture, ImDrawData* draw_data, ImVec4 clear_color)
+{
+    if (texture.Format() != TextureFormat::Rgba8)
+    {
+        return false;
+    }
+
+    // the main loop's rasterizer keeps the frame being presented
+    static SoftwareRasterizer rasterizer(1);
+    rasterizer.Resize(texture.Width(), texture.Height());
+    rasterizer.Clear(clear_color);
+    rasterizer.RenderDrawData(draw_data);
+    texture.UpdateRegion(0, 0, rasterizer.Width(), rasterizer.Height(), rasterizer.Pixels(),
+                         rasterizer.Stride() * 4);
+    return true;
+}
+
+int RunApplication(Application& app, AppWindowConfig window_config)
+{
+    return DoMain_Software(app, window_config);
+}
@@ -0,0 +1,236 @@
+#include "damage_tracker.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    bool SameVertex(const ImDrawVert& a, const ImDrawVert& b)
+    {
+        // ImDrawVert has no padding
+        return memcmp(&a, &b, sizeof(ImDrawVert)) == 0;
+    }
+
+    // everything except the element range, which moves whenever geometry before it changes
+    bool SameState(const ImDrawCmd& a, const ImDrawCmd& b)
+    {
+        return memcmp(&a.ClipRect, &b.ClipRect, sizeof(a.ClipRect)) == 0 &&
+               a.TextureId == b.TextureId && a.VtxOffset == b.VtxOffset &&
+               a.UserCallback == b.UserCallback && a.UserCallbackData == b.UserCallbackData;
+    }
+
+    float Area(const ImVec4& r)
+    {
+        return (r.z - r.x) * (r.w - r.y);
+    }
+
+    ImVec4 Union(const ImVec4& a, const ImVec4& b)
+    {
+        return {std::min(a.x, b.x), std::min(a.y, b.y), std::max(a.z, b.z), std::max(a.w, b.w)};
+    }
+
+    bool Overlaps(const ImVec4& a, const ImVec4& b)
+    {
+        return a.x <= b.z && b.x <= a.z && a.y <= b.w && b.y <= a.w;
+    }
+
+    void Extend(ImVec4& bounds, const ImVec2& pos)
+    {
+        bounds.x = std::min(bounds.x, pos.x);
+        bounds.y = std::min(bounds.y, pos.y);
+        bounds.z = std::max(bounds.z, pos.x);
+        bounds.w = std::max(bounds.w, pos.y);
+    }
+} // namespace
+
+bool DamageTracker::Update(const ImDrawData* draw_data, const ImDrawList* const* sources)
+{
+    rects_.clear();
+    if (sources == nullptr)
+    {
+        sources = draw_data->CmdLists;
+    }
+
+    bool partial = valid_ && static_cast<int>(lists_.size()) == draw_data->CmdListsCount;
+    for (int i = 0; partial && i < draw_data->CmdListsCount; ++i)
+    {
+        partial = lists_[i].list == sources[i];
+    }
+
+    if (partial)
+    {
+        for (int i = 0; i < draw_data->CmdListsCount; ++i)
+        {
+            DiffList(lists_[i], *draw_data->CmdLists[i]);
+        }
+    }
+
+    lists_.resize(draw_data->CmdListsCount);
+    for (int i = 0; i < draw_data->CmdListsCount; ++i)
+    {
+        const ImDrawList* list = draw_data->CmdLists[i];
+        lists_[i].list         = sources[i];
+        lists_[i].vtx.assign(list->VtxBuffer.begin(), list->VtxBuffer.end());
+        lists_[i].idx.assign(list->IdxBuffer.begin(), list->IdxBuffer.end());
+        lists_[i].cmds.assign(list->CmdBuffer.begin(), list->CmdBuffer.end());
+    }
+    valid_ = true;
+
+    return partial;
+}
+
+void DamageTracker::DiffList(const ListState& prev, const ImDrawList& list)
+{
+    const ImDrawVert* old_vtx = prev.vtx.data();
+    const ImDrawVert* new_vtx = list.VtxBuffer.Data;
+    int old_count             = static_cast<int>(prev.vtx.size());
+    int new_count             = list.VtxBuffer.Size;
+
+    bool same_state = static_cast<int>(prev.cmds.size()) == list.CmdBuffer.Size;
+    for (int i = 0; same_state && i < list.CmdBuffer.Size; ++i)
+    {
+        same_state = SameState(prev.cmds[i], list.CmdBuffer[i]);
+    }
+
+    if (!same_state)
+    {
+        AddBounds(old_vtx, old_vtx + old_count);
+        AddBounds(new_vtx, new_vtx + new_count);
+        return;
+    }
+
+    // Geometry is emitted in draw order, so a change shows up as a run of vertices between a
+    // common prefix and a common suffix. The suffix may have moved in the buffer, but its
+    // positions are absolute, so it is drawn at the same place.
+    int common = std::min(old_count, new_count);
+    int prefix = 0;
+    while (prefix < common && SameVertex(old_vtx[prefix], new_vtx[prefix]))
+    {
+        prefix += 1;
+    }
+
+    int suffix = 0;
+    while (suffix < common - prefix &&
+           SameVertex(old_vtx[old_count - 1 - suffix], new_vtx[new_count - 1 - suffix]))
+    {
+        suffix += 1;
+    }
+
+    // A triangle that uses a changed vertex may also span unchanged ones, e.g. a rectangle that
+    // grows by moving two of its corners, so the damage is the bounds of those triangles
+    AddTriangles(old_vtx, prev.idx.data(), prev.cmds.data(), static_cast<int>(prev.cmds.size()),
+                 prefix, old_count - suffix);
+    AddTriangles(new_vtx, list.IdxBuffer.Data, list.CmdBuffer.Data, list.CmdBuffer.Size, prefix,
+                 new_count - suffix);
+}
+
+void DamageTracker::AddBounds(const ImDrawVert* begin, const ImDrawVert* end)
+{
+    if (begin == end)
+    {
+        return;
+    }
+
+    ImVec4 bounds = {FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX};
+    for (const ImDrawVert* v = begin; v != end; ++v)
+    {
+        Extend(bounds, v->pos);
+    }
+
+    // round outwards, with a pixel of margin for anti-aliased edges
+    AddRect({floorf(bounds.x) - 1.f, floorf(bounds.y) - 1.f, ceilf(bounds.z) + 1.f,
+             ceilf(bounds.w) + 1.f});
+}
+
+void DamageTracker::AddTriangles(const ImDrawVert* vtx, const ImDrawIdx* idx, const ImDrawCmd* cmds,
+                                 int cmd_count, int changed_begin, int changed_end)
+{
+    if (changed_begin >= changed_end)
+    {
+        return;
+    }
+
+    auto changed = [changed_begin, changed_end](int vertex) {
+        return vertex >= changed_begin && vertex < changed_end;
+    };
+
+    ImVec4 bounds = {FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX};
+    for (int i = 0; i < cmd_count; ++i)
+    {
+        const ImDrawCmd& cmd = cmds[i];
+        if (cmd.UserCallback != nullptr)
+        {
+            continue;
+        }
+
+        const ImDrawIdx* end = idx + cmd.IdxOffset + cmd.ElemCount;
+        for (const ImDrawIdx* tri = idx + cmd.IdxOffset; tri + 2 < end; tri += 3)
+        {
+            int a = static_cast<int>(cmd.VtxOffset + tri[0]);
+            int b = static_cast<int>(cmd.VtxOffset + tri[1]);
+            int c = static_cast<int>(cmd.VtxOffset + tri[2]);
+            if (changed(a) || changed(b) || changed(c))
+            {
+                Extend(bounds, vtx[a].pos);
+                Extend(bounds, vtx[b].pos);
+                Extend(bounds, vtx[c].pos);
+            }
+        }
+    }
+
+    // changed vertices that no triangle uses are not drawn
+    if (bounds.x > bounds.z)
+    {
+        return;
+    }
+
+    // round outwards, with a pixel of margin for anti-aliased edges
+    AddRect({floorf(bounds.x) - 1.f, floorf(bounds.y) - 1.f, ceilf(bounds.z) + 1.f,
+             ceilf(bounds.w) + 1.f});
+}
+
+void DamageTracker::AddRect(ImVec4 rect)
+{
+    // absorb every rectangle that overlaps the new one
+    for (size_t i = 0; i < rects_.size();)
+    {
+        if (Overlaps(rects_[i], rect))
+        {
+            rect      = Union(rects_[i], rect);
+            rects_[i] = rects_.back();
+            rects_.pop_back();
+            i = 0;
+        }
+        else
+        {
+            i += 1;
+        }
+    }
+    rects_.push_back(rect);
+
+    // then merge the pair that wastes the least area until we are within budget
+    while (static_cast<int>(rects_.size()) > kMaxRects)
+    {
+        size_t best_i = 0, best_j = 1;
+        float best_waste = FLT_MAX;
+        for (size_t i = 0; i < rects_.size(); ++i)
+        {
+            for (size_t j = i + 1; j < rects_.size(); ++j)
+            {
+                float waste =
+                    Area(Union(rects_[i], rects_[j])) - Area(rects_[i]) - Area(rects_[j]);
+                if (waste < best_waste)
+                {
+                    best_i     = i;
+                    best_j     = j;
+                    best_waste = waste;
+                }
+            }
+        }
+
+        rects_[best_i] = Union(rects_[best_i], rects_[best_j]);
+        rects_[best_j] = rects_.back();
+        rects_.pop_back();
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "imgui.h"
+#include <vector>
+
+// finds the screen regions in which a frame differs from the previous one, by diffing the vertex
+// buffers of every draw list against a copy kept from the previous frame, a region covers every
+// triangle that uses a changed vertex, in both frames
+//
+// Rectangles are (x1, y1, x2, y2) in imgui coordinates, the same space as ImDrawCmd::ClipRect.
+class DamageTracker
+{
+public:
+    // more rectangles are merged, as every rectangle costs a pass over the draw data
+    static constexpr int kMaxRects = 4;
+
+    // diff against the previous frame and remember this one, returns false if the whole frame must
+    // be redrawn, e.g. because windows were reordered
+    // `sources` identify the draw lists across frames if `draw_data` is a copy, see
+    // DrawDataSnapshot::SourceLists(), they are only compared, never dereferenced
+    bool Update(const ImDrawData* draw_data, const ImDrawList* const* sources = nullptr);
+
+    // the next Update() reports a full redraw, used when state outside of the draw data changed
+    void Invalidate()
+    {
+        valid_ = false;
+    }
+
+    const std::vector<ImVec4>& Rects() const
+    {
+        return rects_;
+    }
+
+private:
+    struct ListState
+    {
+        const ImDrawList* list = nullptr;
+        std::vector<ImDrawVert> vtx;
+        std::vector<ImDrawIdx> idx;
+        std::vector<ImDrawCmd> cmds;
+    };
+
+    void DiffList(const ListState& prev, const ImDrawList& list);
+    void AddBounds(const ImDrawVert* begin, const ImDrawVert* end);
+    void AddTriangles(const ImDrawVert* vtx, const ImDrawIdx* idx, const ImDrawCmd* cmds,
+                      int cmd_count, int changed_begin, int changed_end);
+    void AddRect(ImVec4 rect);
+
+    // one entry per draw list of the previous frame, reused so that steady state does not allocate
+    std::vector<ListState> lists_;
+    std::vector<ImVec4> rects_;
+    bool valid_ = false;
+};
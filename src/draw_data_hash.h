@@ -0,0 +1,122 @@
+#pragma once
+#include "imgui.h"
+#include <cstdint>
+#include <cstring>
+
+// XXH64 of a buffer, see https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0)
+{
+    constexpr uint64_t kPrime1 = 11400714785074694791ull;
+    constexpr uint64_t kPrime2 = 14029467366897019727ull;
+    constexpr uint64_t kPrime3 = 1609587929392839161ull;
+    constexpr uint64_t kPrime4 = 9650029242287828579ull;
+    constexpr uint64_t kPrime5 = 2870177450012600261ull;
+
+    auto rotl   = [](uint64_t x, int r) { return (x << r) | (x >> (64 - r)); };
+    auto round  = [&](uint64_t acc, uint64_t input) {
+        return rotl(acc + input * kPrime2, 31) * kPrime1;
+    };
+    auto merge  = [&](uint64_t acc, uint64_t v) { return (acc ^ round(0, v)) * kPrime1 + kPrime4; };
+    auto read64 = [](const uint8_t* p) {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    };
+    auto read32 = [](const uint8_t* p) {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    };
+
+    const uint8_t* p   = static_cast<const uint8_t*>(data);
+    const uint8_t* end = p + size;
+
+    uint64_t h;
+    if (size >= 32)
+    {
+        uint64_t v1 = seed + kPrime1 + kPrime2;
+        uint64_t v2 = seed + kPrime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - kPrime1;
+        for (; end - p >= 32; p += 32)
+        {
+            v1 = round(v1, read64(p));
+            v2 = round(v2, read64(p + 8));
+            v3 = round(v3, read64(p + 16));
+            v4 = round(v4, read64(p + 24));
+        }
+
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = merge(h, v1);
+        h = merge(h, v2);
+        h = merge(h, v3);
+        h = merge(h, v4);
+    }
+    else
+    {
+        h = seed + kPrime5;
+    }
+
+    h += size;
+    for (; end - p >= 8; p += 8)
+    {
+        h = rotl(h ^ round(0, read64(p)), 27) * kPrime1 + kPrime4;
+    }
+    if (end - p >= 4)
+    {
+        h = rotl(h ^ (read32(p) * kPrime1), 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    for (; p < end; ++p)
+    {
+        h = rotl(h ^ (*p * kPrime5), 11) * kPrime1;
+    }
+
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+// fingerprint of everything that ends up on screen for `draw_data`, `seed` should cover state
+// outside of the draw data, e.g. the clear color
+//
+// Returns 0 if the frame cannot be compared, i.e. it contains user callbacks, which may draw
+// anything.
+inline uint64_t HashDrawData(const ImDrawData* draw_data, uint64_t seed)
+{
+    const float display[] = {draw_data->DisplayPos.x,       draw_data->DisplayPos.y,
+                             draw_data->DisplaySize.x,      draw_data->DisplaySize.y,
+                             draw_data->FramebufferScale.x, draw_data->FramebufferScale.y};
+    uint64_t h = HashBytes(display, sizeof(display), seed);
+
+    for (int i = 0; i < draw_data->CmdListsCount; ++i)
+    {
+        const ImDrawList* list = draw_data->CmdLists[i];
+        h = HashBytes(list->VtxBuffer.Data, list->VtxBuffer.Size * sizeof(ImDrawVert), h);
+        h = HashBytes(list->IdxBuffer.Data, list->IdxBuffer.Size * sizeof(ImDrawIdx), h);
+
+        for (const ImDrawCmd& cmd : list->CmdBuffer)
+        {
+            if (cmd.UserCallback != nullptr && cmd.UserCallback != ImDrawCallback_ResetRenderState)
+            {
+                return 0;
+            }
+
+            // field by field, ImDrawCmd has padding
+            const uint64_t fields[] = {
+                reinterpret_cast<uintptr_t>(cmd.TextureId),
+                cmd.VtxOffset,
+                cmd.IdxOffset,
+                cmd.ElemCount,
+                reinterpret_cast<uintptr_t>(cmd.UserCallback),
+            };
+            h = HashBytes(&cmd.ClipRect, sizeof(cmd.ClipRect), h);
+            h = HashBytes(fields, sizeof(fields), h);
+        }
+    }
+
+    return h != 0 ? h : 1;
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include "imgui.h"
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// a deep copy of ImDrawData that stays valid after the next ImGui::NewFrame(), so that it can be
+// rendered on another thread while the following frame is being built
+//
+// The vertex, index and command buffers of all draw lists are packed into one arena that only
+// grows, so once the arena and the list pool have reached the size of the largest frame, capturing
+// does not allocate anymore.
+class DrawDataSnapshot
+{
+public:
+    DrawDataSnapshot() = default;
+    ~DrawDataSnapshot()
+    {
+        // the buffers point into arena_, which imgui must not try to free
+        for (auto& list : lists_)
+        {
+            Detach(list->CmdBuffer);
+            Detach(list->IdxBuffer);
+            Detach(list->VtxBuffer);
+        }
+    }
+
+    DrawDataSnapshot(const DrawDataSnapshot&) = delete;
+    DrawDataSnapshot& operator=(const DrawDataSnapshot&) = delete;
+
+    void Capture(const ImDrawData* src)
+    {
+        size_t size = 0;
+        for (int i = 0; i < src->CmdListsCount; ++i)
+        {
+            const ImDrawList* list = src->CmdLists[i];
+            size += AlignedSize(list->CmdBuffer) + AlignedSize(list->IdxBuffer) +
+                    AlignedSize(list->VtxBuffer);
+        }
+        if (arena_.size() < size)
+        {
+            arena_.resize(size);
+        }
+
+        while (static_cast<int>(lists_.size()) < src->CmdListsCount)
+        {
+            lists_.push_back(std::make_unique<ImDrawList>(nullptr));
+            list_ptrs_.push_back(lists_.back().get());
+        }
+        sources_.assign(src->CmdLists, src->CmdLists + src->CmdListsCount);
+
+        char* cursor = arena_.data();
+        for (int i = 0; i < src->CmdListsCount; ++i)
+        {
+            const ImDrawList* list = src->CmdLists[i];
+            ImDrawList* copy       = lists_[i].get();
+
+            Assign(copy->CmdBuffer, list->CmdBuffer, cursor);
+            Assign(copy->IdxBuffer, list->IdxBuffer, cursor);
+            Assign(copy->VtxBuffer, list->VtxBuffer, cursor);
+            copy->Flags = list->Flags;
+        }
+
+        data_          = *src;
+        data_.CmdLists = list_ptrs_.data();
+    }
+
+    // NOTE user callbacks in the command buffers are invoked with the copied draw lists
+    ImDrawData* DrawData()
+    {
+        return &data_;
+    }
+
+    // the draw lists that were captured, which identify them across frames, e.g. for
+    // DamageTracker, as the copies alternate between snapshots
+    // NOTE only valid for comparison, the lists may have been destroyed since
+    const ImDrawList* const* SourceLists() const
+    {
+        return sources_.data();
+    }
+
+private:
+    static constexpr size_t kAlignment = 16;
+
+    template <typename T>
+    static size_t AlignedSize(const ImVector<T>& v)
+    {
+        return (v.Size * sizeof(T) + kAlignment - 1) & ~(kAlignment - 1);
+    }
+
+    // point `dst` at a copy of `src` in the arena, advancing `cursor`
+    template <typename T>
+    static void Assign(ImVector<T>& dst, const ImVector<T>& src, char*& cursor)
+    {
+        if (src.Size > 0)
+        {
+            memcpy(cursor, src.Data, src.Size * sizeof(T));
+        }
+
+        dst.Data     = reinterpret_cast<T*>(cursor);
+        dst.Size     = src.Size;
+        dst.Capacity = src.Size;
+        cursor += AlignedSize(src);
+    }
+
+    template <typename T>
+    static void Detach(ImVector<T>& v)
+    {
+        v.Data     = nullptr;
+        v.Size     = 0;
+        v.Capacity = 0;
+    }
+
+    ImDrawData data_ = {};
+
+    // aligned to alignof(std::max_align_t) by the allocator, every chunk is kAlignment aligned
+    std::vector<char> arena_;
+    std::vector<std::unique_ptr<ImDrawList>> lists_;
+    std::vector<ImDrawList*> list_ptrs_;
+    std::vector<const ImDrawList*> sources_;
+};
@@ -0,0 +1,622 @@
+#include "dynamic_font_atlas.h"
+#include "platform.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+// a private copy, imgui_draw.cpp compiles its own stb_truetype as static as well
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "imstb_truetype.h"
+
+namespace
+{
+    // built up front for dynamic fonts, a merged font relies on the one it is merged into
+    const ImWchar kBaseRanges[]   = {0x0020, 0x007E, 0};
+    const ImWchar kMergedRanges[] = {0x0020, 0x0020, 0};
+
+    // u of a placeholder carries the index of its glyph, past the texture's own [0, 1] range
+    // The texture repeats, so placeholders sample the transparent rows at its bottom.
+    constexpr float kPlaceholderU = 2.f;
+    constexpr int kReservedRows   = 2;
+    constexpr int kPadding        = 1;
+
+    constexpr int kInitialCells     = 256;
+    constexpr int kMaxTextureHeight = 4096;
+    constexpr int kGlyphsPerUpdate  = 256;
+
+    // glyphs drawn within this many frames are only evicted once the texture cannot grow anymore
+    constexpr int kKeepFrames = 120;
+
+    struct Source
+    {
+        int config_index      = 0;
+        const ImWchar* ranges = nullptr;
+
+        stbtt_fontinfo info = {};
+        float scale         = 0.f;
+    };
+
+    struct Glyph
+    {
+        ImFont* font  = nullptr;
+        int index     = 0; // in font->Glyphs
+        int source    = 0;
+        int stb_glyph = 0;
+
+        // as reported by the font, and after imgui's spacing and rounding
+        float raw_advance_x = 0.f;
+        float advance_x     = 0.f;
+
+        int cell       = -1;
+        bool requested = false;
+        bool too_large = false;
+    };
+
+    // a slot of the grid below the glyphs that were built up front
+    struct Cell
+    {
+        int glyph           = -1;
+        int last_used_frame = 0;
+    };
+
+    struct DynamicFonts
+    {
+        std::vector<Source> sources;
+        std::vector<Glyph> glyphs;
+        std::vector<Cell> cells;
+        std::vector<int> free_cells;
+        std::vector<int> requested;
+
+        ImFontAtlas* atlas = nullptr;
+        PlatformTexture::Ptr texture;
+
+        // replaced textures, kept until the frames referencing them have been rendered
+        std::vector<std::pair<PlatformTexture::Ptr, int>> retired;
+
+        // CPU copy of the texture's alpha, rows that changed since the last upload
+        std::vector<uint8_t> alpha;
+        int dirty_begin = 0;
+        int dirty_end   = 0;
+
+        int width       = 0;
+        int height      = 0;
+        int cells_top   = 0;
+        int cell_width  = 0;
+        int cell_height = 0;
+        int columns     = 0;
+
+        // AddGlyph() applies the config's spacing and rounding, the result is copied out of it
+        ImFont scratch;
+
+        uint64_t rasterized = 0;
+        uint64_t evictions  = 0;
+    };
+
+    DynamicFonts& Fonts()
+    {
+        static DynamicFonts fonts;
+        return fonts;
+    }
+
+    void SetPlaceholder(DynamicFonts& fonts, int id)
+    {
+        const Glyph& glyph = fonts.glyphs[id];
+        ImFontGlyph& out   = glyph.font->Glyphs[glyph.index];
+
+        // visible and of some size, so that imgui emits a quad for it, glyphs that will never
+        // fit stay hidden
+        out.Visible  = glyph.too_large ? 0 : 1;
+        out.AdvanceX = glyph.advance_x;
+        out.X0       = 0.f;
+        out.Y0       = 0.f;
+        out.X1       = std::max(glyph.advance_x, 1.f);
+        out.Y1       = glyph.font->FontSize;
+        out.U0 = out.U1 = kPlaceholderU + static_cast<float>(id) + 0.5f;
+        out.V0 = out.V1 = (fonts.height - kReservedRows / 2.f) / fonts.height;
+    }
+
+    void UploadRows(DynamicFonts& fonts, PlatformTexture& texture, int begin, int end)
+    {
+        std::vector<uint32_t> rgba(static_cast<size_t>(fonts.width) * (end - begin));
+        const uint8_t* alpha = &fonts.alpha[static_cast<size_t>(begin) * fonts.width];
+        for (size_t i = 0; i < rgba.size(); ++i)
+        {
+            rgba[i] = IM_COL32(255, 255, 255, alpha[i]);
+        }
+
+        texture.UpdateRegion(0, begin, fonts.width, end - begin, rgba.data(), fonts.width * 4);
+    }
+
+    // move to a taller texture, everything packed so far keeps its pixel position
+    bool Resize(DynamicFonts& fonts, int height)
+    {
+        auto texture = AllocateTexture(fonts.width, height);
+        if (texture == nullptr)
+        {
+            return false;
+        }
+
+        float scale        = static_cast<float>(fonts.height) / height;
+        ImFontAtlas& atlas = *fonts.atlas;
+        atlas.TexUvScale.y *= scale;
+        atlas.TexUvWhitePixel.y *= scale;
+#ifdef IM_DRAWLIST_TEX_LINES_WIDTH_MAX
+        for (ImVec4& uv : atlas.TexUvLines)
+        {
+            uv.y *= scale;
+            uv.w *= scale;
+        }
+#endif
+        for (ImFont* font : atlas.Fonts)
+        {
+            for (ImFontGlyph& glyph : font->Glyphs)
+            {
+                glyph.V0 *= scale;
+                glyph.V1 *= scale;
+            }
+        }
+
+        fonts.height = height;
+        fonts.alpha.resize(static_cast<size_t>(fonts.width) * height, 0);
+
+        // new cells are handed out top to bottom
+        int first = static_cast<int>(fonts.cells.size());
+        int rows  = (height - kReservedRows - fonts.cells_top) / fonts.cell_height;
+        fonts.cells.resize(static_cast<size_t>(rows) * fonts.columns);
+        for (int i = static_cast<int>(fonts.cells.size()) - 1; i >= first; --i)
+        {
+            fonts.free_cells.push_back(i);
+        }
+
+        for (int i = 0; i < static_cast<int>(fonts.glyphs.size()); ++i)
+        {
+            if (fonts.glyphs[i].cell < 0)
+            {
+                SetPlaceholder(fonts, i);
+            }
+        }
+
+        UploadRows(fonts, *texture, 0, height);
+        fonts.dirty_begin = fonts.dirty_end = 0;
+
+        if (fonts.texture != nullptr)
+        {
+            fonts.retired.emplace_back(std::move(fonts.texture), ImGui::GetFrameCount());
+        }
+        fonts.texture = std::move(texture);
+        atlas.TexID   = fonts.texture->Id();
+        return true;
+    }
+
+    // evict an eighth of the cells, least recently drawn first, of those last drawn before `frame`
+    bool EvictBefore(DynamicFonts& fonts, int frame)
+    {
+        std::vector<std::pair<int, int>> candidates;
+        for (int i = 0; i < static_cast<int>(fonts.cells.size()); ++i)
+        {
+            const Cell& cell = fonts.cells[i];
+            if (cell.glyph >= 0 && cell.last_used_frame < frame)
+            {
+                candidates.emplace_back(cell.last_used_frame, i);
+            }
+        }
+        if (candidates.empty())
+        {
+            return false;
+        }
+
+        size_t count = std::max<size_t>(1, fonts.cells.size() / 8);
+        count        = std::min(count, candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+        for (size_t i = 0; i < count; ++i)
+        {
+            Cell& cell = fonts.cells[candidates[i].second];
+
+            fonts.glyphs[cell.glyph].cell = -1;
+            SetPlaceholder(fonts, cell.glyph);
+            cell.glyph = -1;
+            fonts.free_cells.push_back(candidates[i].second);
+        }
+
+        fonts.evictions += count;
+        return true;
+    }
+
+    // glyphs drawn in this frame or the previous one, which may still be rendering, are never
+    // evicted
+    int AllocateCell(DynamicFonts& fonts, int frame)
+    {
+        if (fonts.free_cells.empty() && !EvictBefore(fonts, frame - kKeepFrames) &&
+            !(fonts.height < kMaxTextureHeight && Resize(fonts, fonts.height * 2)) &&
+            !EvictBefore(fonts, frame - 1))
+        {
+            return -1;
+        }
+
+        int cell = fonts.free_cells.back();
+        fonts.free_cells.pop_back();
+        return cell;
+    }
+
+    // the same layout as ImFontAtlasBuildWithStbTruetype() produces for the glyph
+    bool Rasterize(DynamicFonts& fonts, int id, int cell, int frame)
+    {
+        Glyph& glyph               = fonts.glyphs[id];
+        const Source& source       = fonts.sources[glyph.source];
+        const ImFontConfig& config = fonts.atlas->ConfigData[source.config_index];
+
+        int oversample_h = config.OversampleH;
+        int oversample_v = config.OversampleV;
+        float scale_x    = source.scale * oversample_h;
+        float scale_y    = source.scale * oversample_v;
+
+        int x0, y0, x1, y1;
+        stbtt_GetGlyphBitmapBoxSubpixel(&source.info, glyph.stb_glyph, scale_x, scale_y, 0.f, 0.f,
+                                        &x0, &y0, &x1, &y1);
+        int width  = x1 - x0 + oversample_h - 1;
+        int height = y1 - y0 + oversample_v - 1;
+        if (width + 2 * kPadding > fonts.cell_width || height + 2 * kPadding > fonts.cell_height)
+        {
+            glyph.too_large = true;
+            SetPlaceholder(fonts, id);
+            return false;
+        }
+
+        int cell_x = (cell % fonts.columns) * fonts.cell_width;
+        int cell_y = fonts.cells_top + (cell / fonts.columns) * fonts.cell_height;
+        for (int row = 0; row < fonts.cell_height; ++row)
+        {
+            memset(&fonts.alpha[static_cast<size_t>(cell_y + row) * fonts.width + cell_x], 0,
+                   fonts.cell_width);
+        }
+
+        int x = cell_x + kPadding;
+        int y = cell_y + kPadding;
+
+        float sub_x = 0.f;
+        float sub_y = 0.f;
+        if (x1 > x0 && y1 > y0)
+        {
+            uint8_t* out = &fonts.alpha[static_cast<size_t>(y) * fonts.width + x];
+            stbtt_MakeGlyphBitmapSubpixelPrefilter(&source.info, out, width, height, fonts.width,
+                                                   scale_x, scale_y, 0.f, 0.f, oversample_h,
+                                                   oversample_v, &sub_x, &sub_y, glyph.stb_glyph);
+
+            if (config.RasterizerMultiply != 1.f)
+            {
+                for (int row = 0; row < height; ++row)
+                {
+                    for (int col = 0; col < width; ++col)
+                    {
+                        uint8_t& a = out[static_cast<size_t>(row) * fonts.width + col];
+                        a = static_cast<uint8_t>(std::min(255.f, a * config.RasterizerMultiply));
+                    }
+                }
+            }
+        }
+        else
+        {
+            width = height = 0;
+        }
+
+        float quad_x0 = x0 / static_cast<float>(oversample_h) + sub_x + config.GlyphOffset.x;
+        float quad_y0 = y0 / static_cast<float>(oversample_v) + sub_y + config.GlyphOffset.y +
+                        std::floor(glyph.font->Ascent + 0.5f);
+        float quad_x1 = quad_x0 + width / static_cast<float>(oversample_h);
+        float quad_y1 = quad_y0 + height / static_cast<float>(oversample_v);
+
+        float inv_w = 1.f / fonts.width;
+        float inv_h = 1.f / fonts.height;
+        auto c      = static_cast<ImWchar>(glyph.font->Glyphs[glyph.index].Codepoint);
+
+        fonts.scratch.Glyphs.resize(0);
+        fonts.scratch.AddGlyph(&config, c, quad_x0, quad_y0, quad_x1, quad_y1, x * inv_w,
+                               y * inv_h, (x + width) * inv_w, (y + height) * inv_h,
+                               glyph.raw_advance_x);
+        glyph.font->Glyphs[glyph.index] = fonts.scratch.Glyphs[0];
+
+        glyph.cell        = cell;
+        fonts.cells[cell] = {id, frame};
+        fonts.rasterized += 1;
+
+        if (fonts.dirty_end <= fonts.dirty_begin)
+        {
+            fonts.dirty_begin = cell_y;
+            fonts.dirty_end   = cell_y;
+        }
+        fonts.dirty_begin = std::min(fonts.dirty_begin, cell_y);
+        fonts.dirty_end   = std::max(fonts.dirty_end, cell_y + fonts.cell_height);
+        return true;
+    }
+
+    // a vertex of the font texture, either a placeholder or a glyph that is still in use
+    void MarkVertex(DynamicFonts& fonts, const ImVec2& uv, int frame)
+    {
+        if (uv.x >= kPlaceholderU)
+        {
+            auto id = static_cast<size_t>(uv.x - kPlaceholderU);
+            if (id < fonts.glyphs.size() && !fonts.glyphs[id].requested)
+            {
+                fonts.glyphs[id].requested = true;
+                fonts.requested.push_back(static_cast<int>(id));
+            }
+            return;
+        }
+
+        int y      = static_cast<int>(uv.y * fonts.height) - fonts.cells_top;
+        int column = static_cast<int>(uv.x * fonts.width) / fonts.cell_width;
+        if (y < 0 || column >= fonts.columns)
+        {
+            return;
+        }
+
+        size_t cell = static_cast<size_t>(y / fonts.cell_height) * fonts.columns + column;
+        if (cell < fonts.cells.size())
+        {
+            fonts.cells[cell].last_used_frame = frame;
+        }
+    }
+} // namespace
+
+ImFont* AddDynamicFontFromFileTTF(const char* filename, float size_pixels,
+                                  const ImFontConfig* font_cfg, const ImWchar* glyph_ranges)
+{
+    ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+    ImFont* font       = atlas->AddFontFromFileTTF(filename, size_pixels, font_cfg, glyph_ranges);
+    if (font != nullptr)
+    {
+        Source source;
+        source.config_index = atlas->ConfigData.Size - 1;
+        Fonts().sources.push_back(source);
+    }
+
+    return font;
+}
+
+DynamicFontStats GetDynamicFontStats()
+{
+    const DynamicFonts& fonts = Fonts();
+
+    DynamicFontStats stats;
+    stats.glyphs          = static_cast<int>(fonts.glyphs.size());
+    stats.resident_glyphs = static_cast<int>(fonts.cells.size() - fonts.free_cells.size());
+    stats.texture_width   = fonts.texture != nullptr ? fonts.width : 0;
+    stats.texture_height  = fonts.texture != nullptr ? fonts.height : 0;
+    stats.rasterized      = fonts.rasterized;
+    stats.evictions       = fonts.evictions;
+    return stats;
+}
+
+void PrepareDynamicFonts(ImFontAtlas& atlas)
+{
+    DynamicFonts& fonts = Fonts();
+    for (Source& source : fonts.sources)
+    {
+        ImFontConfig& config = atlas.ConfigData[source.config_index];
+        source.ranges =
+            config.GlyphRanges != nullptr ? config.GlyphRanges : atlas.GetGlyphRangesDefault();
+        config.GlyphRanges = config.MergeMode ? kMergedRanges : kBaseRanges;
+    }
+
+    // dynamic glyphs go below the built ones, a wider texture fits more of them per row
+    if (!fonts.sources.empty() && atlas.TexDesiredWidth == 0)
+    {
+        atlas.TexDesiredWidth = 1024;
+    }
+}
+
+bool HasDynamicFonts()
+{
+    return !Fonts().sources.empty();
+}
+
+bool AttachDynamicFonts(ImFontAtlas& atlas)
+{
+    DynamicFonts& fonts = Fonts();
+    if (fonts.sources.empty())
+    {
+        return false;
+    }
+
+    unsigned char* pixels;
+    int width, height;
+    atlas.GetTexDataAsAlpha8(&pixels, &width, &height);
+
+    fonts.atlas                  = &atlas;
+    fonts.scratch.ContainerAtlas = &atlas;
+    fonts.width                  = width;
+    fonts.height                 = height;
+    fonts.cells_top              = height;
+    fonts.alpha.assign(pixels, pixels + static_cast<size_t>(width) * height);
+
+    // one cell size for all dynamic fonts, large enough for their largest glyphs
+    for (Source& source : fonts.sources)
+    {
+        const ImFontConfig& config = atlas.ConfigData[source.config_index];
+        auto data                  = static_cast<const unsigned char*>(config.FontData);
+        if (!stbtt_InitFont(&source.info, data, stbtt_GetFontOffsetForIndex(data, config.FontNo)))
+        {
+            fprintf(stderr, "failed to load the dynamic font %s\n", config.Name);
+            return false;
+        }
+
+        source.scale = config.SizePixels > 0.f
+                           ? stbtt_ScaleForPixelHeight(&source.info, config.SizePixels)
+                           : stbtt_ScaleForMappingEmToPixels(&source.info, -config.SizePixels);
+
+        // some fonts have a few huge glyphs that set the bounding box, those are hidden instead
+        int x0, y0, x1, y1;
+        stbtt_GetFontBoundingBox(&source.info, &x0, &y0, &x1, &y1);
+        float limit   = 2.f * std::fabs(config.SizePixels);
+        float glyph_w = std::min((x1 - x0) * source.scale, limit);
+        float glyph_h = std::min((y1 - y0) * source.scale, limit);
+
+        int cell_w = static_cast<int>(std::ceil(glyph_w * config.OversampleH)) +
+                     config.OversampleH - 1 + 2 * kPadding;
+        int cell_h = static_cast<int>(std::ceil(glyph_h * config.OversampleV)) +
+                     config.OversampleV - 1 + 2 * kPadding;
+        fonts.cell_width  = std::max(fonts.cell_width, cell_w);
+        fonts.cell_height = std::max(fonts.cell_height, cell_h);
+    }
+
+    fonts.columns = width / fonts.cell_width;
+    if (fonts.columns == 0)
+    {
+        fprintf(stderr, "the font atlas is too narrow for dynamic glyphs\n");
+        return false;
+    }
+
+    // a placeholder for every glyph in the ranges that was not built up front, only their
+    // advances are looked up now
+    for (int i = 0; i < static_cast<int>(fonts.sources.size()); ++i)
+    {
+        const Source& source       = fonts.sources[i];
+        const ImFontConfig& config = atlas.ConfigData[source.config_index];
+        ImFont* font               = config.DstFont;
+
+        for (const ImWchar* range = source.ranges; range[0] != 0 && range[1] != 0; range += 2)
+        {
+            for (unsigned int c = range[0]; c <= range[1]; ++c)
+            {
+                if (font->FindGlyphNoFallback(static_cast<ImWchar>(c)) != nullptr)
+                {
+                    continue;
+                }
+
+                int stb_glyph = stbtt_FindGlyphIndex(&source.info, c);
+                if (stb_glyph == 0)
+                {
+                    continue;
+                }
+
+                int advance, left_side_bearing;
+                stbtt_GetGlyphHMetrics(&source.info, stb_glyph, &advance, &left_side_bearing);
+
+                Glyph glyph;
+                glyph.font          = font;
+                glyph.index         = font->Glyphs.Size;
+                glyph.source        = i;
+                glyph.stb_glyph     = stb_glyph;
+                glyph.raw_advance_x = advance * source.scale;
+
+                fonts.scratch.Glyphs.resize(0);
+                fonts.scratch.AddGlyph(&config, static_cast<ImWchar>(c), 0.f, 0.f, 0.f, 0.f, 0.f,
+                                       0.f, 0.f, 0.f, glyph.raw_advance_x);
+                glyph.advance_x = fonts.scratch.Glyphs[0].AdvanceX;
+
+                font->Glyphs.push_back(fonts.scratch.Glyphs[0]);
+                fonts.glyphs.push_back(glyph);
+                SetPlaceholder(fonts, static_cast<int>(fonts.glyphs.size()) - 1);
+            }
+        }
+
+        font->BuildLookupTable();
+    }
+
+    // room for the first glyphs
+    int rows           = (kInitialCells + fonts.columns - 1) / fonts.columns;
+    int texture_height = 64;
+    while (texture_height < fonts.cells_top + rows * fonts.cell_height + kReservedRows &&
+           texture_height < kMaxTextureHeight)
+    {
+        texture_height *= 2;
+    }
+
+    return Resize(fonts, texture_height);
+}
+
+bool UpdateDynamicFonts(const ImDrawData* draw_data)
+{
+    DynamicFonts& fonts = Fonts();
+    if (fonts.texture == nullptr || draw_data == nullptr)
+    {
+        return false;
+    }
+
+    int frame = ImGui::GetFrameCount();
+    fonts.retired.erase(std::remove_if(fonts.retired.begin(), fonts.retired.end(),
+                                       [frame](const auto& retired) {
+                                           return retired.second < frame - 1;
+                                       }),
+                        fonts.retired.end());
+
+    ImTextureID texture_id = fonts.texture->Id();
+    for (int n = 0; n < draw_data->CmdListsCount; ++n)
+    {
+        const ImDrawList* list = draw_data->CmdLists[n];
+        for (const ImDrawCmd& cmd : list->CmdBuffer)
+        {
+            if (cmd.UserCallback != nullptr || cmd.TextureId != texture_id)
+            {
+                continue;
+            }
+
+            for (unsigned int i = 0; i < cmd.ElemCount; ++i)
+            {
+                ImDrawIdx index = list->IdxBuffer[cmd.IdxOffset + i];
+                MarkVertex(fonts, list->VtxBuffer[cmd.VtxOffset + index].uv, frame);
+            }
+        }
+    }
+
+    // a burst of new text is spread over a few frames
+    bool rasterized = false;
+    bool full       = false;
+    size_t count    = std::min<size_t>(fonts.requested.size(), kGlyphsPerUpdate);
+    for (size_t i = 0; i < count; ++i)
+    {
+        // every cell holds a glyph in use, the rest stay blank
+        int cell = AllocateCell(fonts, frame);
+        if (cell < 0)
+        {
+            full = true;
+            break;
+        }
+
+        if (Rasterize(fonts, fonts.requested[i], cell, frame))
+        {
+            rasterized = true;
+        }
+        else
+        {
+            fonts.free_cells.push_back(cell);
+        }
+    }
+
+    bool pending = !full && count < fonts.requested.size();
+    for (int id : fonts.requested)
+    {
+        fonts.glyphs[id].requested = false;
+    }
+    fonts.requested.clear();
+
+    if (fonts.dirty_end > fonts.dirty_begin)
+    {
+        UploadRows(fonts, *fonts.texture, fonts.dirty_begin, fonts.dirty_end);
+        fonts.dirty_begin = fonts.dirty_end = 0;
+    }
+
+    return rasterized || pending;
+}
+
+void CleanupDynamicFonts()
+{
+    DynamicFonts& fonts = Fonts();
+    if (fonts.atlas != nullptr)
+    {
+        fonts.atlas->TexID = nullptr;
+    }
+
+    fonts.texture.reset();
+    fonts.retired.clear();
+    fonts.sources.clear();
+    fonts.glyphs.clear();
+    fonts.cells.clear();
+    fonts.free_cells.clear();
+    fonts.alpha.clear();
+    fonts.atlas = nullptr;
+}
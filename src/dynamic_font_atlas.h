@@ -0,0 +1,23 @@
+#pragma once
+#include "dynamic_font.h"
+#include "imgui.h"
+
+// used by the backends that rasterize dynamic fonts on demand, in this order
+//
+
+// before the atlas is built, restricts dynamic fonts to the ranges that are built up front
+void PrepareDynamicFonts(ImFontAtlas& atlas);
+
+bool HasDynamicFonts();
+
+// after the atlas is built, replaces the font texture with one that glyphs are added to, the
+// renderer's own font texture must have been destroyed
+// returns false if the atlas has no dynamic fonts or on failure
+bool AttachDynamicFonts(ImFontAtlas& atlas);
+
+// after ImGui::Render(), rasterizes the glyphs that were drawn without being rasterized
+// returns true if another frame should be drawn to show them
+bool UpdateDynamicFonts(const ImDrawData* draw_data);
+
+// releases the font texture, before the renderer is shut down
+void CleanupDynamicFonts();
@@ -0,0 +1,453 @@
+#include "font_atlas_cache.h"
+#include "draw_data_hash.h"
+#include "imgui_internal.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr char kMagic[8]   = {'Q', 'I', 'F', 'O', 'N', 'T', '0', '1'};
+    constexpr char kFileName[] = "imgui_font_atlas.bin";
+
+    // layout of the cache file: the header, TexUvLines, the positions of the atlas' own custom
+    // rects, every font followed by its glyphs, and the alpha8 pixels
+    struct CacheHeader
+    {
+        char magic[8];
+        uint64_t key;
+        int32_t tex_width;
+        int32_t tex_height;
+        ImVec2 uv_scale;
+        ImVec2 uv_white_pixel;
+        int32_t uv_line_count;
+        int32_t custom_rect_count;
+        int32_t font_count;
+        int32_t glyph_size;
+    };
+
+    struct CachedRect
+    {
+        uint16_t x;
+        uint16_t y;
+    };
+
+    struct CachedFont
+    {
+        float font_size;
+        float ascent;
+        float descent;
+        int32_t metrics_total_surface;
+        int32_t config_index;
+        int32_t config_count;
+        uint32_t fallback_char;
+        uint32_t ellipsis_char;
+        int32_t glyph_count;
+    };
+
+    // a read-only view of a whole file, unmapped on destruction
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile()
+        {
+            if (data_ == nullptr)
+            {
+                return;
+            }
+#ifdef _WIN32
+            UnmapViewOfFile(data_);
+#else
+            munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+        }
+
+        // the file handles are closed right away, the mapping keeps the contents alive
+        bool Open(const std::string& path)
+        {
+#ifdef _WIN32
+            HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                                      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+            if (file == INVALID_HANDLE_VALUE)
+            {
+                return false;
+            }
+
+            LARGE_INTEGER size;
+            HANDLE mapping = NULL;
+            if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+            {
+                mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            }
+            CloseHandle(file);
+            if (mapping == NULL)
+            {
+                return false;
+            }
+
+            data_ = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            CloseHandle(mapping);
+            if (data_ == nullptr)
+            {
+                return false;
+            }
+            size_ = static_cast<size_t>(size.QuadPart);
+#else
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                return false;
+            }
+
+            struct stat info;
+            void* data = MAP_FAILED;
+            if (fstat(fd, &info) == 0 && info.st_size > 0)
+            {
+                data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            }
+            close(fd);
+            if (data == MAP_FAILED)
+            {
+                return false;
+            }
+
+            data_ = static_cast<const uint8_t*>(data);
+            size_ = static_cast<size_t>(info.st_size);
+#endif
+            return true;
+        }
+
+        const uint8_t* Data() const
+        {
+            return data_;
+        }
+        size_t Size() const
+        {
+            return size_;
+        }
+
+    private:
+        const uint8_t* data_ = nullptr;
+        size_t size_         = 0;
+    };
+
+    // bounds checked reads from the mapping, a truncated file fails instead of reading past it
+    struct Reader
+    {
+        const uint8_t* p;
+        const uint8_t* end;
+
+        const uint8_t* Take(size_t size)
+        {
+            if (static_cast<size_t>(end - p) < size)
+            {
+                return nullptr;
+            }
+
+            const uint8_t* taken = p;
+            p += size;
+            return taken;
+        }
+
+        template <typename T>
+        bool Read(T& value)
+        {
+            const uint8_t* data = Take(sizeof(T));
+            if (data == nullptr)
+            {
+                return false;
+            }
+
+            memcpy(&value, data, sizeof(T));
+            return true;
+        }
+    };
+
+    template <typename T>
+    void Append(std::vector<uint8_t>& out, const T* data, size_t count = 1)
+    {
+        auto bytes = reinterpret_cast<const uint8_t*>(data);
+        out.insert(out.end(), bytes, bytes + sizeof(T) * count);
+    }
+
+    // everything that the built atlas depends on
+    uint64_t AtlasKey(ImFontAtlas& atlas)
+    {
+        uint64_t key = IMGUI_VERSION_NUM;
+        auto mix     = [&key](const void* data, size_t size) { key = HashBytes(data, size, key); };
+        auto mix_pod = [&mix](const auto& value) { mix(&value, sizeof(value)); };
+
+        mix_pod(atlas.Flags);
+        mix_pod(atlas.TexDesiredWidth);
+        mix_pod(atlas.TexGlyphPadding);
+        for (const ImFontConfig& config : atlas.ConfigData)
+        {
+            mix(config.FontData, config.FontDataSize);
+            mix_pod(config.FontNo);
+            mix_pod(config.SizePixels);
+            mix_pod(config.OversampleH);
+            mix_pod(config.OversampleV);
+            mix_pod(config.PixelSnapH);
+            mix_pod(config.GlyphExtraSpacing);
+            mix_pod(config.GlyphOffset);
+            mix_pod(config.GlyphMinAdvanceX);
+            mix_pod(config.GlyphMaxAdvanceX);
+            mix_pod(config.MergeMode);
+            mix_pod(config.RasterizerFlags);
+            mix_pod(config.RasterizerMultiply);
+            mix_pod(config.EllipsisChar);
+
+            // pairs of inclusive bounds, terminated by 0
+            const ImWchar* ranges =
+                config.GlyphRanges != nullptr ? config.GlyphRanges : atlas.GetGlyphRangesDefault();
+            size_t count = 0;
+            while (ranges[count] != 0)
+            {
+                count += 1;
+            }
+            mix(ranges, count * sizeof(ImWchar));
+        }
+
+        return key;
+    }
+
+    bool LoadAtlas(ImFontAtlas& atlas, const std::string& path, uint64_t key)
+    {
+        MappedFile file;
+        if (!file.Open(path))
+        {
+            return false;
+        }
+
+        Reader reader{file.Data(), file.Data() + file.Size()};
+        CacheHeader header;
+        if (!reader.Read(header) || memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+            header.key != key || header.glyph_size != sizeof(ImFontGlyph) ||
+            header.font_count != atlas.Fonts.Size || header.tex_width <= 0 ||
+            header.tex_height <= 0)
+        {
+            return false;
+        }
+
+        const uint8_t* uv_lines = reader.Take(sizeof(ImVec4) * header.uv_line_count);
+        const uint8_t* rects    = reader.Take(sizeof(CachedRect) * header.custom_rect_count);
+        if (uv_lines == nullptr || rects == nullptr)
+        {
+            return false;
+        }
+
+        // validate all fonts before the atlas is touched
+        std::vector<std::pair<CachedFont, const uint8_t*>> fonts;
+        for (int i = 0; i < header.font_count; ++i)
+        {
+            CachedFont font;
+            if (!reader.Read(font) || font.config_index < 0 ||
+                font.config_index + font.config_count > atlas.ConfigData.Size ||
+                font.glyph_count < 0)
+            {
+                return false;
+            }
+
+            const uint8_t* glyphs = reader.Take(sizeof(ImFontGlyph) * font.glyph_count);
+            if (glyphs == nullptr)
+            {
+                return false;
+            }
+            fonts.emplace_back(font, glyphs);
+        }
+
+        size_t pixel_bytes    = static_cast<size_t>(header.tex_width) * header.tex_height;
+        const uint8_t* pixels = reader.Take(pixel_bytes);
+        if (pixels == nullptr)
+        {
+            return false;
+        }
+
+        // registers the same custom rects as Build(), the cache stores where they were packed
+        ImFontAtlasBuildInit(&atlas);
+        if (atlas.CustomRects.Size != header.custom_rect_count)
+        {
+            return false;
+        }
+        for (int i = 0; i < header.custom_rect_count; ++i)
+        {
+            CachedRect rect;
+            memcpy(&rect, rects + i * sizeof(CachedRect), sizeof(rect));
+            atlas.CustomRects[i].X = rect.x;
+            atlas.CustomRects[i].Y = rect.y;
+        }
+
+#ifdef IM_DRAWLIST_TEX_LINES_WIDTH_MAX
+        if (header.uv_line_count != IM_ARRAYSIZE(atlas.TexUvLines))
+        {
+            return false;
+        }
+        memcpy(atlas.TexUvLines, uv_lines, sizeof(atlas.TexUvLines));
+#endif
+
+        // NOTE the atlas frees its pixels itself, they are copied out of the mapping
+        atlas.TexWidth        = header.tex_width;
+        atlas.TexHeight       = header.tex_height;
+        atlas.TexUvScale      = header.uv_scale;
+        atlas.TexUvWhitePixel = header.uv_white_pixel;
+        atlas.TexPixelsAlpha8 = static_cast<unsigned char*>(IM_ALLOC(pixel_bytes));
+        memcpy(atlas.TexPixelsAlpha8, pixels, pixel_bytes);
+
+        for (int i = 0; i < header.font_count; ++i)
+        {
+            const auto& [cached, glyphs] = fonts[i];
+
+            ImFont* font = atlas.Fonts[i];
+            font->ClearOutputData();
+            font->FontSize            = cached.font_size;
+            font->Ascent              = cached.ascent;
+            font->Descent             = cached.descent;
+            font->MetricsTotalSurface = cached.metrics_total_surface;
+            font->ConfigData          = &atlas.ConfigData[cached.config_index];
+            font->ConfigDataCount     = static_cast<short>(cached.config_count);
+            font->ContainerAtlas      = &atlas;
+            font->FallbackChar        = static_cast<ImWchar>(cached.fallback_char);
+            font->EllipsisChar        = static_cast<ImWchar>(cached.ellipsis_char);
+
+            font->Glyphs.resize(cached.glyph_count);
+            memcpy(font->Glyphs.Data, glyphs, sizeof(ImFontGlyph) * cached.glyph_count);
+            font->BuildLookupTable();
+        }
+
+        return true;
+    }
+
+    void SaveAtlas(ImFontAtlas& atlas, const std::filesystem::path& path, uint64_t key)
+    {
+        unsigned char* pixels;
+        int width, height;
+        atlas.GetTexDataAsAlpha8(&pixels, &width, &height);
+        if (pixels == nullptr)
+        {
+            return;
+        }
+
+        CacheHeader header = {};
+        memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.key               = key;
+        header.tex_width         = width;
+        header.tex_height        = height;
+        header.uv_scale          = atlas.TexUvScale;
+        header.uv_white_pixel    = atlas.TexUvWhitePixel;
+        header.custom_rect_count = atlas.CustomRects.Size;
+        header.font_count        = atlas.Fonts.Size;
+        header.glyph_size        = sizeof(ImFontGlyph);
+#ifdef IM_DRAWLIST_TEX_LINES_WIDTH_MAX
+        header.uv_line_count = IM_ARRAYSIZE(atlas.TexUvLines);
+#endif
+
+        std::vector<uint8_t> data;
+        Append(data, &header);
+#ifdef IM_DRAWLIST_TEX_LINES_WIDTH_MAX
+        Append(data, atlas.TexUvLines, IM_ARRAYSIZE(atlas.TexUvLines));
+#endif
+        for (const ImFontAtlasCustomRect& rect : atlas.CustomRects)
+        {
+            CachedRect cached = {rect.X, rect.Y};
+            Append(data, &cached);
+        }
+        for (const ImFont* font : atlas.Fonts)
+        {
+            auto config_index = font->ConfigData - atlas.ConfigData.Data;
+
+            CachedFont cached;
+            cached.font_size             = font->FontSize;
+            cached.ascent                = font->Ascent;
+            cached.descent               = font->Descent;
+            cached.metrics_total_surface = font->MetricsTotalSurface;
+            cached.config_index          = static_cast<int32_t>(config_index);
+            cached.config_count          = font->ConfigDataCount;
+            cached.fallback_char         = font->FallbackChar;
+            cached.ellipsis_char         = font->EllipsisChar;
+            cached.glyph_count           = font->Glyphs.Size;
+            Append(data, &cached);
+            Append(data, font->Glyphs.Data, font->Glyphs.Size);
+        }
+        Append(data, pixels, static_cast<size_t>(width) * height);
+
+        // written to the side and renamed, so that a concurrent launch never maps a partial file
+        std::filesystem::path temp_path = path;
+        temp_path += ".tmp";
+
+        FILE* file = fopen(temp_path.string().c_str(), "wb");
+        if (file == nullptr)
+        {
+            fprintf(stderr, "failed to write the font atlas cache %s\n",
+                    temp_path.string().c_str());
+            return;
+        }
+        bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+        written &= fclose(file) == 0;
+
+        std::error_code error;
+        if (written)
+        {
+            std::filesystem::rename(temp_path, path, error);
+        }
+        if (!written || error)
+        {
+            fprintf(stderr, "failed to write the font atlas cache %s\n", path.string().c_str());
+            std::filesystem::remove(temp_path, error);
+        }
+    }
+} // namespace
+
+bool BuildFontAtlas(Application& app, ImFontAtlas& atlas)
+{
+    // the default font is what Build() would add anyway, add it first so that it is part of the key
+    if (atlas.ConfigData.empty())
+    {
+        atlas.AddFontDefault();
+    }
+
+    // custom rects registered by the application are drawn by it after the build, those atlases
+    // are not cached
+    const std::string& dir = app.RenderingConfig().font_cache_dir;
+    bool cacheable         = !dir.empty() && !atlas.IsBuilt() && atlas.CustomRects.empty();
+
+    bool cached = false;
+    if (cacheable)
+    {
+        uint64_t key               = AtlasKey(atlas);
+        std::filesystem::path path = std::filesystem::path(dir) / kFileName;
+
+        cached = LoadAtlas(atlas, path.string(), key);
+        if (!cached)
+        {
+            // a stale or corrupt file may have left a partial atlas behind
+            atlas.ClearTexData();
+            atlas.Build();
+
+            std::error_code error;
+            std::filesystem::create_directories(dir, error);
+            SaveAtlas(atlas, path, key);
+        }
+    }
+    else if (!atlas.IsBuilt())
+    {
+        atlas.Build();
+    }
+
+    app.RecordFontAtlas(cached);
+    return cached;
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include "application.h"
+#include "imgui.h"
+
+// build the font atlas, or restore it from the cache in AppRenderingConfig::font_cache_dir if the
+// same fonts were built before, and record on `app` whether it was
+// returns true if the atlas was restored from the cache
+//
+// The cache is keyed by the contents of the font files, their sizes, glyph ranges and other build
+// settings, any change rebuilds the atlas and replaces the cache file.
+//
+// NOTE called by the backends after Application::Initialize(), before the first NewFrame()
+bool BuildFontAtlas(Application& app, ImFontAtlas& atlas);
@@ -0,0 +1,161 @@
+// OpenGL entry points above the GL 3.0 core that src/glad/gl.h was generated for, resolved at
+// runtime so that the OpenGL3 backends can use them where the driver provides them
+//
+// An OpenGL loader must have been included before this header.
+
+#pragma once
+#include <cstring>
+
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif
+#ifndef GL_SYNC_FLUSH_COMMANDS_BIT
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#endif
+#ifndef GL_TIMEOUT_IGNORED
+#define GL_TIMEOUT_IGNORED 0xFFFFFFFFFFFFFFFFull
+#endif
+#ifndef GL_ALREADY_SIGNALED
+#define GL_ALREADY_SIGNALED 0x911A
+#endif
+#ifndef GL_TIMEOUT_EXPIRED
+#define GL_TIMEOUT_EXPIRED 0x911B
+#endif
+#ifndef GL_CONDITION_SATISFIED
+#define GL_CONDITION_SATISFIED 0x911C
+#endif
+
+#ifndef GL_TEXTURE_SWIZZLE_RGBA
+#define GL_TEXTURE_SWIZZLE_RGBA 0x8E46
+#endif
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+#if defined(_WIN32)
+#define QUICK_IMGUI_GL_APIENTRY __stdcall
+#else
+#define QUICK_IMGUI_GL_APIENTRY
+#endif
+
+struct GlExtensions
+{
+    // GL_ARB_sync, core since 3.2, only resolved where supported
+    using FenceSyncFn      = GLsync(QUICK_IMGUI_GL_APIENTRY*)(GLenum, GLbitfield);
+    using DeleteSyncFn     = void(QUICK_IMGUI_GL_APIENTRY*)(GLsync);
+    using ClientWaitSyncFn = GLenum(QUICK_IMGUI_GL_APIENTRY*)(GLsync, GLbitfield, GLuint64);
+    using WaitSyncFn       = void(QUICK_IMGUI_GL_APIENTRY*)(GLsync, GLbitfield, GLuint64);
+
+    FenceSyncFn FenceSync           = nullptr;
+    DeleteSyncFn DeleteSync         = nullptr;
+    ClientWaitSyncFn ClientWaitSync = nullptr;
+    WaitSyncFn WaitSync             = nullptr;
+
+    // GL_ARB_draw_elements_base_vertex, core since 3.2, only resolved where supported
+    using DrawElementsBaseVertexFn =
+        void(QUICK_IMGUI_GL_APIENTRY*)(GLenum, GLsizei, GLenum, const void*, GLint);
+
+    DrawElementsBaseVertexFn DrawElementsBaseVertex = nullptr;
+
+    // GL_ARB_texture_swizzle, core since 3.3
+    bool TextureSwizzle = false;
+
+    // GL_ARB_get_program_binary, core since 4.1, only resolved where supported
+    using GetProgramBinaryFn =
+        void(QUICK_IMGUI_GL_APIENTRY*)(GLuint, GLsizei, GLsizei*, GLenum*, void*);
+    using ProgramBinaryFn = void(QUICK_IMGUI_GL_APIENTRY*)(GLuint, GLenum, const void*, GLsizei);
+    using ProgramParameteriFn = void(QUICK_IMGUI_GL_APIENTRY*)(GLuint, GLenum, GLint);
+
+    GetProgramBinaryFn GetProgramBinary   = nullptr;
+    ProgramBinaryFn ProgramBinary         = nullptr;
+    ProgramParameteriFn ProgramParameteri = nullptr;
+
+    bool HasSync() const
+    {
+        return FenceSync && DeleteSync && ClientWaitSync && WaitSync;
+    }
+
+    bool HasProgramBinary() const
+    {
+        return GetProgramBinary && ProgramBinary && ProgramParameteri;
+    }
+
+    // `load` resolves a function by name, e.g. glfwGetProcAddress, a context must be current
+    template <typename LoadFn>
+    void Load(LoadFn load)
+    {
+        GLint major = 0, minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+        // some loaders return a pointer for any name, whether the driver supports it or not
+        bool gl32 = major > 3 || (major == 3 && minor >= 2);
+        if (gl32 || HasExtension("GL_ARB_sync"))
+        {
+            Resolve(FenceSync, load, "glFenceSync");
+            Resolve(DeleteSync, load, "glDeleteSync");
+            Resolve(ClientWaitSync, load, "glClientWaitSync");
+            Resolve(WaitSync, load, "glWaitSync");
+        }
+
+        if (gl32 || HasExtension("GL_ARB_draw_elements_base_vertex"))
+        {
+            Resolve(DrawElementsBaseVertex, load, "glDrawElementsBaseVertex");
+        }
+
+        bool gl33 = major > 3 || (major == 3 && minor >= 3);
+
+        TextureSwizzle = gl33 || HasExtension("GL_ARB_texture_swizzle") ||
+                         HasExtension("GL_EXT_texture_swizzle");
+
+        // a driver may expose the extension without supporting any binary format
+        bool gl41 = major > 4 || (major == 4 && minor >= 1);
+        if (gl41 || HasExtension("GL_ARB_get_program_binary"))
+        {
+            GLint formats = 0;
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+            if (formats > 0)
+            {
+                Resolve(GetProgramBinary, load, "glGetProgramBinary");
+                Resolve(ProgramBinary, load, "glProgramBinary");
+                Resolve(ProgramParameteri, load, "glProgramParameteri");
+            }
+        }
+    }
+
+    static bool HasExtension(const char* name)
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; ++i)
+        {
+            const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            if (extension != nullptr && strcmp(extension, name) == 0)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+private:
+    template <typename Fn, typename LoadFn>
+    static void Resolve(Fn& fn, LoadFn load, const char* name)
+    {
+        fn = reinterpret_cast<Fn>(load(name));
+    }
+};
+
+inline GlExtensions& GlExt()
+{
+    static GlExtensions ext;
+    return ext;
+}
@@ -0,0 +1,200 @@
+// Lazy alternative to gladLoadGL() for the OpenGL3 backends, resolves only the entry points of
+// src/glad/gl.h that QuickImGui's renderers call, each on its first call, instead of all ~600 of
+// them at startup
+//
+// src/glad/gl.h must have been included before this header.
+
+#pragma once
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// the functions called by renderer_gl3.cpp, texture_gl3.h, gl_ext.h and the backends, the others
+// stay null, so applications calling GL directly must load it fully
+#define QUICK_IMGUI_LAZY_GL_FUNCTIONS(X)                                                           \
+    X(ActiveTexture)                                                                               \
+    X(AttachShader)                                                                                \
+    X(BindBuffer)                                                                                  \
+    X(BindFramebuffer)                                                                             \
+    X(BindRenderbuffer)                                                                            \
+    X(BindTexture)                                                                                 \
+    X(BindVertexArray)                                                                             \
+    X(BlendEquation)                                                                               \
+    X(BlendEquationSeparate)                                                                       \
+    X(BlendFunc)                                                                                   \
+    X(BlendFuncSeparate)                                                                           \
+    X(BlitFramebuffer)                                                                             \
+    X(BufferData)                                                                                  \
+    X(CheckFramebufferStatus)                                                                      \
+    X(Clear)                                                                                       \
+    X(ClearColor)                                                                                  \
+    X(CompileShader)                                                                               \
+    X(CreateProgram)                                                                               \
+    X(CreateShader)                                                                                \
+    X(DeleteBuffers)                                                                               \
+    X(DeleteFramebuffers)                                                                          \
+    X(DeleteProgram)                                                                               \
+    X(DeleteRenderbuffers)                                                                         \
+    X(DeleteShader)                                                                                \
+    X(DeleteTextures)                                                                              \
+    X(DeleteVertexArrays)                                                                          \
+    X(DetachShader)                                                                                \
+    X(Disable)                                                                                     \
+    X(DrawElements)                                                                                \
+    X(Enable)                                                                                      \
+    X(EnableVertexAttribArray)                                                                     \
+    X(Finish)                                                                                      \
+    X(Flush)                                                                                       \
+    X(FramebufferRenderbuffer)                                                                     \
+    X(FramebufferTexture2D)                                                                        \
+    X(GenBuffers)                                                                                  \
+    X(GenFramebuffers)                                                                             \
+    X(GenRenderbuffers)                                                                            \
+    X(GenTextures)                                                                                 \
+    X(GenVertexArrays)                                                                             \
+    X(GetAttribLocation)                                                                           \
+    X(GetError)                                                                                    \
+    X(GetIntegerv)                                                                                 \
+    X(GetProgramInfoLog)                                                                           \
+    X(GetProgramiv)                                                                                \
+    X(GetShaderInfoLog)                                                                            \
+    X(GetShaderiv)                                                                                 \
+    X(GetStringi)                                                                                  \
+    X(GetUniformLocation)                                                                          \
+    X(IsEnabled)                                                                                   \
+    X(LinkProgram)                                                                                 \
+    X(MapBufferRange)                                                                              \
+    X(PixelStorei)                                                                                 \
+    X(PolygonMode)                                                                                 \
+    X(ReadPixels)                                                                                  \
+    X(RenderbufferStorage)                                                                         \
+    X(Scissor)                                                                                     \
+    X(ShaderSource)                                                                                \
+    X(TexImage2D)                                                                                  \
+    X(TexParameteri)                                                                               \
+    X(TexParameteriv)                                                                              \
+    X(TexSubImage2D)                                                                               \
+    X(Uniform1i)                                                                                   \
+    X(UniformMatrix4fv)                                                                            \
+    X(UnmapBuffer)                                                                                 \
+    X(UseProgram)                                                                                  \
+    X(VertexAttribPointer)                                                                         \
+    X(Viewport)
+
+namespace GlLazy
+{
+    inline GLADloadfunc& Loader()
+    {
+        static GLADloadfunc load = nullptr;
+        return load;
+    }
+
+    inline GLADapiproc Resolve(const char* name)
+    {
+        GLADapiproc proc = Loader() ? Loader()(name) : nullptr;
+        if (proc == nullptr)
+        {
+            fprintf(stderr, "Failed to resolve %s!\n", name);
+            abort();
+        }
+
+        return proc;
+    }
+
+    // installed in place of the function, replaces itself with the resolved one and forwards
+    template <typename Entry, typename Fn>
+    struct Thunk;
+
+    template <typename Entry, typename R, typename... Args>
+    struct Thunk<Entry, R(GLAD_API_PTR*)(Args...)>
+    {
+        using Fn = R(GLAD_API_PTR*)(Args...);
+
+        static R GLAD_API_PTR Call(Args... args)
+        {
+            Fn fn          = reinterpret_cast<Fn>(Resolve(Entry::kName));
+            Entry::Slot() = fn;
+            return fn(args...);
+        }
+
+        static bool IsPending()
+        {
+            return Entry::Slot() == &Call;
+        }
+    };
+
+#define QUICK_IMGUI_LAZY_GL_ENTRY(name)                                                            \
+    struct Entry_##name                                                                            \
+    {                                                                                              \
+        static constexpr const char* kName = "gl" #name;                                           \
+        static auto& Slot()                                                                        \
+        {                                                                                          \
+            return glad_gl##name;                                                                  \
+        }                                                                                          \
+    };                                                                                             \
+    using Thunk_##name = Thunk<Entry_##name, decltype(glad_gl##name)>;
+
+    QUICK_IMGUI_LAZY_GL_FUNCTIONS(QUICK_IMGUI_LAZY_GL_ENTRY)
+#undef QUICK_IMGUI_LAZY_GL_ENTRY
+
+    // resolves the functions that were not called yet, e.g. before the context is shared with
+    // another thread, which would race on the thunks replacing themselves
+    inline void ResolveAll()
+    {
+#define QUICK_IMGUI_LAZY_GL_RESOLVE(name)                                                          \
+    if (Thunk_##name::IsPending())                                                                 \
+    {                                                                                              \
+        Entry_##name::Slot() = reinterpret_cast<decltype(glad_gl##name)>(Resolve("gl" #name));    \
+    }
+        QUICK_IMGUI_LAZY_GL_FUNCTIONS(QUICK_IMGUI_LAZY_GL_RESOLVE)
+#undef QUICK_IMGUI_LAZY_GL_RESOLVE
+    }
+} // namespace GlLazy
+
+// like gladLoadGL(), returns the context version as GLAD_MAKE_VERSION() or 0 on failure
+// NOTE `load` is kept for the thunks, it must stay valid as long as the context is used
+inline int LoadGLLazy(GLADloadfunc load)
+{
+    // glGetString is needed right away to check the version, as glad does
+    glad_glGetString = reinterpret_cast<PFNGLGETSTRINGPROC>(load("glGetString"));
+    if (glad_glGetString == nullptr)
+    {
+        return 0;
+    }
+
+    const char* version = reinterpret_cast<const char*>(glad_glGetString(GL_VERSION));
+    if (version == nullptr)
+    {
+        return 0;
+    }
+
+    const char* prefix = "OpenGL ES ";
+    if (strncmp(version, prefix, strlen(prefix)) == 0)
+    {
+        version += strlen(prefix);
+    }
+
+    int major = 0, minor = 0;
+    if (sscanf(version, "%d.%d", &major, &minor) != 2)
+    {
+        return 0;
+    }
+
+    GLAD_GL_VERSION_1_0 = major >= 1;
+    GLAD_GL_VERSION_1_1 = (major == 1 && minor >= 1) || major > 1;
+    GLAD_GL_VERSION_1_2 = (major == 1 && minor >= 2) || major > 1;
+    GLAD_GL_VERSION_1_3 = (major == 1 && minor >= 3) || major > 1;
+    GLAD_GL_VERSION_1_4 = (major == 1 && minor >= 4) || major > 1;
+    GLAD_GL_VERSION_1_5 = (major == 1 && minor >= 5) || major > 1;
+    GLAD_GL_VERSION_2_0 = major >= 2;
+    GLAD_GL_VERSION_2_1 = (major == 2 && minor >= 1) || major > 2;
+    GLAD_GL_VERSION_3_0 = major >= 3;
+
+    GlLazy::Loader() = load;
+#define QUICK_IMGUI_LAZY_GL_INSTALL(name)                                                          \
+    GlLazy::Entry_##name::Slot() = &GlLazy::Thunk_##name::Call;
+    QUICK_IMGUI_LAZY_GL_FUNCTIONS(QUICK_IMGUI_LAZY_GL_INSTALL)
+#undef QUICK_IMGUI_LAZY_GL_INSTALL
+
+    return GLAD_MAKE_VERSION(major, minor);
+}
@@ -0,0 +1,220 @@
+#include "imgui_format.h"
+#include "imgui_internal.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    constexpr size_t kBlockSize = 16 * 1024;
+
+    struct ScratchBlock
+    {
+        std::unique_ptr<char[]> Data;
+        size_t Size;
+    };
+
+    // the blocks are kept when the arena is reset, so that formatting stops allocating after the
+    // first frames
+    struct ScratchArena
+    {
+        std::vector<ScratchBlock> Blocks;
+        size_t Block = 0;
+        size_t Used  = 0;
+
+        ImGuiContext* Context = nullptr;
+        int Frame             = -1;
+
+        void ResetOnNewFrame()
+        {
+            ImGuiContext* context = ImGui::GetCurrentContext();
+            int frame             = context ? ImGui::GetFrameCount() : -1;
+            if (context != Context || frame != Frame)
+            {
+                Context = context;
+                Frame   = frame;
+                Block   = 0;
+                Used    = 0;
+            }
+
+            if (Blocks.empty())
+            {
+                Blocks.push_back({std::make_unique<char[]>(kBlockSize), kBlockSize});
+            }
+        }
+
+        // moves to the next block with at least `size` bytes
+        void NextBlock(size_t size)
+        {
+            Block += 1;
+            Used = 0;
+
+            while (Block < Blocks.size() && Blocks[Block].Size < size)
+            {
+                Block += 1;
+            }
+            if (Block == Blocks.size())
+            {
+                size = std::max(size, kBlockSize);
+                Blocks.push_back({std::make_unique<char[]>(size), size});
+            }
+        }
+    };
+
+    // per thread, as panels are built on worker threads, see OffscreenPanels
+    thread_local ScratchArena Arena;
+} // namespace
+
+ImGui::FormatDetail::Writer::Writer()
+{
+    Arena.ResetOnNewFrame();
+
+    ScratchBlock& block = Arena.Blocks[Arena.Block];
+    begin_              = block.Data.get() + Arena.Used;
+    pos_                = begin_;
+    end_                = block.Data.get() + block.Size;
+}
+
+void ImGui::FormatDetail::Writer::Grow(size_t length)
+{
+    // the string so far moves to a block with room for twice its size
+    size_t size = static_cast<size_t>(pos_ - begin_);
+    Arena.NextBlock(2 * (size + length));
+
+    ScratchBlock& block = Arena.Blocks[Arena.Block];
+    memcpy(block.Data.get(), begin_, size);
+    begin_ = block.Data.get();
+    pos_   = begin_ + size;
+    end_   = block.Data.get() + block.Size;
+}
+
+std::string_view ImGui::FormatDetail::Writer::Finish()
+{
+    *Reserve(1) = '\0';
+
+    Arena.Used = static_cast<size_t>(pos_ + 1 - Arena.Blocks[Arena.Block].Data.get());
+    return {begin_, static_cast<size_t>(pos_ - begin_)};
+}
+
+void ImGui::FormatDetail::WriteInteger(Writer& writer, long long value)
+{
+    char* first = writer.Reserve(24);
+    writer.Commit(std::to_chars(first, first + 24, value).ptr);
+}
+
+void ImGui::FormatDetail::WriteInteger(Writer& writer, unsigned long long value)
+{
+    char* first = writer.Reserve(24);
+    writer.Commit(std::to_chars(first, first + 24, value).ptr);
+}
+
+namespace
+{
+    template <typename T>
+    void WriteFloatImpl(ImGui::FormatDetail::Writer& writer, T value, int precision)
+    {
+        // fixed notation of large numbers is long, to_chars() reports it not fitting
+        size_t length = precision < 0 ? 32 : 320 + static_cast<size_t>(precision);
+        char* first   = writer.Reserve(length);
+#if defined(__cpp_lib_to_chars)
+        std::to_chars_result result =
+            precision < 0 ? std::to_chars(first, first + length, value)
+                          : std::to_chars(first, first + length, value, std::chars_format::fixed,
+                                          precision);
+        writer.Commit(result.ptr);
+#else
+        // NOTE floating point to_chars() is missing from older standard libraries
+        int written = precision < 0 ? snprintf(first, length, "%g", static_cast<double>(value))
+                                    : snprintf(first, length, "%.*f", precision,
+                                               static_cast<double>(value));
+        writer.Commit(first + std::min(static_cast<size_t>(std::max(written, 0)), length - 1));
+#endif
+    }
+} // namespace
+
+void ImGui::FormatDetail::WriteFloat(Writer& writer, float value, int precision)
+{
+    WriteFloatImpl(writer, value, precision);
+}
+
+void ImGui::FormatDetail::WriteFloat(Writer& writer, double value, int precision)
+{
+    WriteFloatImpl(writer, value, precision);
+}
+
+void ImGui::FormatDetail::WritePointer(Writer& writer, const void* value)
+{
+    char* first = writer.Reserve(2 + 2 * sizeof(void*));
+    first[0]    = '0';
+    first[1]    = 'x';
+
+    auto address = reinterpret_cast<uintptr_t>(value);
+    writer.Commit(std::to_chars(first + 2, first + 2 + 2 * sizeof(void*), address, 16).ptr);
+}
+
+void ImGui::FormatDetail::Format(Writer& writer, const char* fmt, const Argument* args)
+{
+    const char* literal = fmt;
+    for (const char* c = fmt; *c != '\0'; ++c)
+    {
+        if (*c != '{' && *c != '}')
+        {
+            continue;
+        }
+
+        writer.Append(literal, static_cast<size_t>(c - literal));
+
+        // "{{" or "}}", the second one starts the next literal
+        if (c[1] == *c)
+        {
+            literal = ++c;
+            continue;
+        }
+
+        int precision = -1;
+        if (c[1] == ':')
+        {
+            precision = 0;
+            for (c += 3; *c != '}'; ++c)
+            {
+                precision = precision * 10 + (*c - '0');
+            }
+        }
+        else
+        {
+            c += 1;
+        }
+
+        args->Write(writer, args->Value, precision);
+        args += 1;
+        literal = c + 1;
+    }
+
+    writer.Append(literal, strlen(literal));
+}
+
+bool ImGui::FormatDetail::SkipItems()
+{
+    return GetCurrentWindow()->SkipItems;
+}
+
+// the same as TreeNodeExV() does after formatting the label
+
+bool ImGui::FormatDetail::TreeNodeEx(const char* str_id, ImGuiTreeNodeFlags flags,
+                                     std::string_view label)
+{
+    ImGuiWindow* window = GetCurrentWindow();
+    return TreeNodeBehavior(window->GetID(str_id), flags, label.data(),
+                            label.data() + label.size());
+}
+
+bool ImGui::FormatDetail::TreeNodeEx(const void* ptr_id, ImGuiTreeNodeFlags flags,
+                                     std::string_view label)
+{
+    ImGuiWindow* window = GetCurrentWindow();
+    return TreeNodeBehavior(window->GetID(ptr_id), flags, label.data(),
+                            label.data() + label.size());
+}
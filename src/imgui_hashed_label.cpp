@@ -0,0 +1,36 @@
+#include "imgui_hashed_label.h"
+#include "imgui_internal.h"
+
+// the same as imgui.cpp and imgui_widgets.cpp do with string labels, up to hashing
+
+ImGuiID ImGui::GetID(const HashedLabel& label)
+{
+    ImGuiWindow* window = GetCurrentWindowRead();
+    ImGuiID id          = label.GetID(window->IDStack.back());
+    KeepAliveID(id);
+    return id;
+}
+
+void ImGui::PushID(const HashedLabel& label)
+{
+    ImGuiWindow* window = GetCurrentWindowRead();
+    window->IDStack.push_back(label.GetID(window->IDStack.back()));
+}
+
+bool ImGui::TreeNode(const HashedLabel& label)
+{
+    return TreeNodeEx(label, 0);
+}
+
+bool ImGui::TreeNodeEx(const HashedLabel& label, ImGuiTreeNodeFlags flags)
+{
+    ImGuiWindow* window = GetCurrentWindow();
+    if (window->SkipItems)
+    {
+        return false;
+    }
+
+    ImGuiID id = label.GetID(window->IDStack.back());
+    KeepAliveID(id);
+    return TreeNodeBehavior(id, flags, label.Text, NULL);
+}
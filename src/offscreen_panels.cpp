@@ -0,0 +1,173 @@
+#include "offscreen_panels.h"
+#include "dynamic_font_atlas.h"
+#include "worker_pool.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#if defined(QUICK_IMGUI_THREADED_PANELS)
+// the current imgui context of each thread, see quick_imgui_config.h
+thread_local ImGuiContext* QuickImGuiContext = nullptr;
+#endif
+
+namespace
+{
+    // NewFrame() locks the shared font atlas and EndFrame() unlocks it, which the panels' contexts
+    // must not do concurrently
+    std::mutex AtlasLockMutex;
+} // namespace
+
+struct OffscreenPanels::Panel
+{
+    int id     = 0;
+    int width  = 0;
+    int height = 0;
+    std::function<void()> draw;
+
+    ImGuiContext* context = nullptr;
+    PlatformTexture::Ptr texture;
+
+    // of the frame built by the last Update(), valid until the next one
+    ImDrawData* draw_data = nullptr;
+
+    ~Panel()
+    {
+        if (context != nullptr)
+        {
+            ImGui::DestroyContext(context);
+        }
+    }
+};
+
+OffscreenPanels::OffscreenPanels(OffscreenPanelsConfig config) : config_(config)
+{
+#if defined(QUICK_IMGUI_THREADED_PANELS)
+    int num_threads = config_.num_threads;
+    if (num_threads <= 0)
+    {
+        num_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+#else
+    // the current imgui context is global, panels are built one after the other
+    int num_threads = 1;
+#endif
+
+    workers_ = std::make_unique<WorkerPool>(num_threads - 1);
+}
+
+OffscreenPanels::~OffscreenPanels() = default;
+
+int OffscreenPanels::Add(int width, int height, std::function<void()> draw)
+{
+    auto panel     = std::make_unique<Panel>();
+    panel->texture = AllocateTexture(width, height, TextureFormat::Rgba8);
+    if (panel->texture == nullptr)
+    {
+        return -1;
+    }
+
+    panel->id     = next_id_++;
+    panel->width  = width;
+    panel->height = height;
+    panel->draw   = std::move(draw);
+
+    // created on the main context's atlas, its glyphs are only read while panels are built
+    ImGuiContext* main     = ImGui::GetCurrentContext();
+    ImGuiStyle& main_style = ImGui::GetStyle();
+    panel->context         = ImGui::CreateContext(ImGui::GetIO().Fonts);
+    ImGui::SetCurrentContext(panel->context);
+    ImGui::GetIO().IniFilename = nullptr;
+    ImGui::GetStyle()          = main_style;
+    ImGui::SetCurrentContext(main);
+
+    panels_.push_back(std::move(panel));
+    return panels_.back()->id;
+}
+
+void OffscreenPanels::Remove(int id)
+{
+    panels_.erase(std::remove_if(panels_.begin(), panels_.end(),
+                                 [id](const auto& panel) { return panel->id == id; }),
+                  panels_.end());
+}
+
+bool OffscreenPanels::Update()
+{
+    using Clock = std::chrono::steady_clock;
+    auto begin  = Clock::now();
+
+    // panels advance with the main context, their frames are built while it waits
+    ImGuiIO& io      = ImGui::GetIO();
+    float delta_time = io.DeltaTime;
+    bool locked      = io.Fonts->Locked;
+    workers_->ParallelFor(static_cast<int>(panels_.size()),
+                          [this, delta_time](int i) { Build(*panels_[i], delta_time); });
+
+    // the last panel's EndFrame() unlocked the atlas in the middle of the main context's frame
+    io.Fonts->Locked = locked;
+    auto built       = Clock::now();
+
+    // rendering needs the main thread's GL context, and the dynamic fonts are only updated once no
+    // panel reads the atlas anymore
+    bool glyphs_added = false;
+    for (const auto& panel : panels_)
+    {
+        RenderToTexture(*panel->texture, panel->draw_data, config_.clear_color);
+        glyphs_added |= UpdateDynamicFonts(panel->draw_data);
+    }
+    auto rendered = Clock::now();
+
+    build_ms_  = std::chrono::duration<double, std::milli>(built - begin).count();
+    render_ms_ = std::chrono::duration<double, std::milli>(rendered - built).count();
+    return glyphs_added;
+}
+
+void OffscreenPanels::Draw(int id) const
+{
+    const Panel* panel = Find(id);
+    if (panel != nullptr)
+    {
+        ImGui::Image(panel->texture->Id(), ImVec2(static_cast<float>(panel->width),
+                                                  static_cast<float>(panel->height)));
+    }
+}
+
+ImTextureID OffscreenPanels::Texture(int id) const
+{
+    const Panel* panel = Find(id);
+    return panel != nullptr ? panel->texture->Id() : nullptr;
+}
+
+OffscreenPanels::Panel* OffscreenPanels::Find(int id) const
+{
+    auto it = std::find_if(panels_.begin(), panels_.end(),
+                           [id](const auto& panel) { return panel->id == id; });
+    return it != panels_.end() ? it->get() : nullptr;
+}
+
+// runs on any thread, which has no current context unless it is the main one
+void OffscreenPanels::Build(Panel& panel, float delta_time)
+{
+    ImGuiContext* previous = ImGui::GetCurrentContext();
+    ImGui::SetCurrentContext(panel.context);
+
+    ImGuiIO& io    = ImGui::GetIO();
+    io.DisplaySize = ImVec2(static_cast<float>(panel.width), static_cast<float>(panel.height));
+    io.DeltaTime   = delta_time > 0.f ? delta_time : 1.f / 60.f;
+    io.MousePos    = ImVec2(-FLT_MAX, -FLT_MAX);
+
+    {
+        std::lock_guard<std::mutex> lock(AtlasLockMutex);
+        ImGui::NewFrame();
+    }
+    panel.draw();
+    {
+        std::lock_guard<std::mutex> lock(AtlasLockMutex);
+        ImGui::Render();
+    }
+    panel.draw_data = ImGui::GetDrawData();
+
+    ImGui::SetCurrentContext(previous);
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "imgui.h"
+
+#include "application.h"
+#include "platform.h"
+#include <cmath>
+#include <string>
+
+// the window of the HEADLESS_GL and SOFTWARE backends, which only remembers what it is told
+class PlatformWindow_Offscreen : public PlatformWindow
+{
+private:
+    std::string title_;
+    int x_      = 0;
+    int y_      = 0;
+    int width_  = 0;
+    int height_ = 0;
+
+public:
+    PlatformWindow_Offscreen(const AppWindowConfig& config)
+    {
+        title_  = config.title;
+        x_      = config.pos_x;
+        y_      = config.pos_y;
+        width_  = config.width;
+        height_ = config.height;
+    }
+
+    virtual void SetTitle(const std::string& title) override
+    {
+        title_ = title;
+    }
+
+    virtual void SetSize(int width, int height) override
+    {
+        width_  = width;
+        height_ = height;
+    }
+    virtual std::pair<int, int> GetSize() override
+    {
+        return {width_, height_};
+    }
+
+    virtual void SetPosition(int x, int y) override
+    {
+        x_ = x;
+        y_ = y;
+    }
+    virtual std::pair<int, int> GetPosition() override
+    {
+        return {x_, y_};
+    }
+};
+
+// move the mouse along a lissajous curve so that hover states change every frame, and hold the
+// left button for a few frames every second
+inline void FeedSyntheticInput(ImGuiIO& io, int frame)
+{
+    float t = static_cast<float>(frame) * io.DeltaTime;
+
+    io.MousePos.x   = (0.5f + 0.45f * sinf(1.3f * t)) * io.DisplaySize.x;
+    io.MousePos.y   = (0.5f + 0.45f * sinf(1.7f * t)) * io.DisplaySize.y;
+    io.MouseDown[0] = frame % 60 < 5;
+}
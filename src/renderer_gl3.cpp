@@ -0,0 +1,731 @@
+#include "renderer_gl3.h"
+#include "draw_data_hash.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <glad/gl.h>
+
+#include "gl_ext.h"
+
+namespace
+{
+    constexpr char kMagic[8]   = {'Q', 'I', 'P', 'R', 'O', 'G', '0', '1'};
+    constexpr char kFileName[] = "imgui_program.bin";
+
+    // the GLSL 130 shaders of imgui_impl_opengl3, which GLSL 150 compiles as well
+    const char* const kVertexShader =
+        "uniform mat4 ProjMtx;\n"
+        "in vec2 Position;\n"
+        "in vec2 UV;\n"
+        "in vec4 Color;\n"
+        "out vec2 Frag_UV;\n"
+        "out vec4 Frag_Color;\n"
+        "void main()\n"
+        "{\n"
+        "    Frag_UV = UV;\n"
+        "    Frag_Color = Color;\n"
+        "    gl_Position = ProjMtx * vec4(Position.xy,0,1);\n"
+        "}\n";
+
+    const char* const kFragmentShader =
+        "uniform sampler2D Texture;\n"
+        "in vec2 Frag_UV;\n"
+        "in vec4 Frag_Color;\n"
+        "out vec4 Out_Color;\n"
+        "void main()\n"
+        "{\n"
+        "    Out_Color = Frag_Color * texture(Texture, Frag_UV.st);\n"
+        "}\n";
+
+    // layout of the cache file: the header followed by `length` bytes of the binary
+    struct CacheHeader
+    {
+        char magic[8];
+        uint64_t key;
+        uint32_t format;
+        int32_t length;
+    };
+
+    // vertex arrays are not shared between contexts, and buffers written by RenderDrawData() calls
+    // on the threads of two contexts would race, as would the uniforms of a shared program, so each
+    // context gets its own, reused across frames
+    struct DrawObjects
+    {
+        void* context       = nullptr;
+        GLuint vertex_array = 0;
+        GLuint vbo          = 0;
+        GLuint ebo          = 0;
+
+        GLuint program     = 0;
+        GLint loc_texture  = 0;
+        GLint loc_proj_mtx = 0;
+        GLint loc_position = 0;
+        GLint loc_uv       = 0;
+        GLint loc_color    = 0;
+    };
+
+    struct RendererState
+    {
+        std::string glsl_version;
+        std::string cache_dir;
+
+        GLuint program      = 0;
+        bool program_cached = false;
+
+        GLuint font_texture = 0;
+
+        Renderer_Gl3::CurrentContextFn current_context = nullptr;
+
+        // guards draw_objects and the program binary, RenderDrawData() may be called on several
+        // threads
+        std::mutex draw_objects_mutex;
+        std::vector<DrawObjects> draw_objects;
+
+        // the binary of `program`, which the programs of the contexts are linked from, empty if
+        // the driver does not support program binaries
+        std::vector<uint8_t> program_binary;
+        GLenum program_binary_format = 0;
+    };
+
+    RendererState& State()
+    {
+        static RendererState state;
+        return state;
+    }
+
+    void* CurrentContext()
+    {
+        Renderer_Gl3::CurrentContextFn current_context = State().current_context;
+        return current_context != nullptr ? current_context() : nullptr;
+    }
+
+    bool CheckShader(GLuint shader, const char* desc)
+    {
+        GLint status = 0, log_length = 0;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &log_length);
+        if (status == GL_FALSE)
+        {
+            fprintf(stderr, "failed to compile the %s shader, GLSL %s\n", desc,
+                    State().glsl_version.c_str());
+        }
+        if (log_length > 1)
+        {
+            std::vector<GLchar> log(log_length + 1);
+            glGetShaderInfoLog(shader, log_length, nullptr, log.data());
+            fprintf(stderr, "%s\n", log.data());
+        }
+        return status == GL_TRUE;
+    }
+
+    bool CheckProgram(GLuint program)
+    {
+        GLint status = 0, log_length = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &status);
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &log_length);
+        if (status == GL_FALSE)
+        {
+            fprintf(stderr, "failed to link the shader program, GLSL %s\n",
+                    State().glsl_version.c_str());
+        }
+        if (log_length > 1)
+        {
+            std::vector<GLchar> log(log_length + 1);
+            glGetProgramInfoLog(program, log_length, nullptr, log.data());
+            fprintf(stderr, "%s\n", log.data());
+        }
+        return status == GL_TRUE;
+    }
+
+    GLuint CompileShader(GLenum type, const char* source, const char* desc)
+    {
+        const GLchar* sources[] = {State().glsl_version.c_str(), "\n", source};
+
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 3, sources, nullptr);
+        glCompileShader(shader);
+        if (!CheckShader(shader, desc))
+        {
+            glDeleteShader(shader);
+            return 0;
+        }
+        return shader;
+    }
+
+    GLuint CompileProgram(bool retrievable)
+    {
+        GLuint vertex   = CompileShader(GL_VERTEX_SHADER, kVertexShader, "vertex");
+        GLuint fragment = CompileShader(GL_FRAGMENT_SHADER, kFragmentShader, "fragment");
+
+        GLuint program = 0;
+        if (vertex != 0 && fragment != 0)
+        {
+            program = glCreateProgram();
+            glAttachShader(program, vertex);
+            glAttachShader(program, fragment);
+            if (retrievable)
+            {
+                GlExt().ProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+            }
+            glLinkProgram(program);
+            glDetachShader(program, vertex);
+            glDetachShader(program, fragment);
+
+            if (!CheckProgram(program))
+            {
+                glDeleteProgram(program);
+                program = 0;
+            }
+        }
+
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+        return program;
+    }
+
+    // identifies the driver and the sources, a binary is only valid for the same of both
+    uint64_t ProgramKey()
+    {
+        uint64_t key = 0;
+        for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+        {
+            const char* value = reinterpret_cast<const char*>(glGetString(name));
+            if (value != nullptr)
+            {
+                key = HashBytes(value, strlen(value) + 1, key);
+            }
+        }
+
+        const std::string& glsl_version = State().glsl_version;
+        key = HashBytes(glsl_version.c_str(), glsl_version.size() + 1, key);
+        key = HashBytes(kVertexShader, strlen(kVertexShader) + 1, key);
+        key = HashBytes(kFragmentShader, strlen(kFragmentShader) + 1, key);
+        return key;
+    }
+
+    // returns 0 if the driver rejects the binary
+    GLuint ProgramFromBinary(const std::vector<uint8_t>& binary, GLenum format)
+    {
+        // drivers validate the binary themselves and fail the link status if they reject it
+        GLuint program = glCreateProgram();
+        GlExt().ProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        GlExt().ProgramBinary(program, format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+        GLint status = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &status);
+        if (status == GL_FALSE)
+        {
+            glDeleteProgram(program);
+            return 0;
+        }
+        return program;
+    }
+
+    // the binary of a linked program, empty if the driver does not return one
+    std::vector<uint8_t> GetBinary(GLuint program, uint32_t& format)
+    {
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+        {
+            return {};
+        }
+
+        std::vector<uint8_t> binary(length);
+        GLsizei written  = 0;
+        GLenum gl_format = 0;
+        GlExt().GetProgramBinary(program, length, &written, &gl_format, binary.data());
+        binary.resize(std::max(written, 0));
+        format = gl_format;
+        return binary;
+    }
+
+    // returns 0 if there is no binary for `key`, or the driver rejects it
+    GLuint LoadProgram(const std::filesystem::path& path, uint64_t key)
+    {
+        FILE* file = fopen(path.string().c_str(), "rb");
+        if (file == nullptr)
+        {
+            return 0;
+        }
+
+        CacheHeader header;
+        std::vector<uint8_t> binary;
+        bool valid = fread(&header, sizeof(header), 1, file) == 1 &&
+                     memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 && header.key == key &&
+                     header.length > 0;
+        if (valid)
+        {
+            binary.resize(header.length);
+            valid = fread(binary.data(), 1, binary.size(), file) == binary.size();
+        }
+        fclose(file);
+
+        if (!valid)
+        {
+            return 0;
+        }
+        return ProgramFromBinary(binary, header.format);
+    }
+
+    void SaveProgram(GLuint program, const std::filesystem::path& path, uint64_t key)
+    {
+        CacheHeader header;
+        memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.key = key;
+
+        std::vector<uint8_t> binary = GetBinary(program, header.format);
+        header.length               = static_cast<int32_t>(binary.size());
+        if (binary.empty())
+        {
+            return;
+        }
+
+        // written to the side and renamed, so that a concurrent launch never reads a partial file
+        std::filesystem::path temp_path = path;
+        temp_path += ".tmp";
+
+        FILE* file = fopen(temp_path.string().c_str(), "wb");
+        if (file == nullptr)
+        {
+            fprintf(stderr, "failed to write the program cache %s\n", temp_path.string().c_str());
+            return;
+        }
+        bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+        written &= fwrite(binary.data(), 1, header.length, file) ==
+                   static_cast<size_t>(header.length);
+        written &= fclose(file) == 0;
+
+        std::error_code error;
+        if (written)
+        {
+            std::filesystem::rename(temp_path, path, error);
+        }
+        if (!written || error)
+        {
+            fprintf(stderr, "failed to write the program cache %s\n", path.string().c_str());
+            std::filesystem::remove(temp_path, error);
+        }
+    }
+
+    // loads the program from the cache if possible, compiles it and updates the cache otherwise
+    GLuint CreateProgram(bool& cached)
+    {
+        cached                 = false;
+        const std::string& dir = State().cache_dir;
+        if (dir.empty() || !GlExt().HasProgramBinary())
+        {
+            // retrievable all the same, the programs of other contexts are linked from its binary
+            return CompileProgram(GlExt().HasProgramBinary());
+        }
+
+        uint64_t key               = ProgramKey();
+        std::filesystem::path path = std::filesystem::path(dir) / kFileName;
+
+        GLuint program = LoadProgram(path, key);
+        if (program != 0)
+        {
+            cached = true;
+            return program;
+        }
+
+        program = CompileProgram(true);
+        if (program != 0)
+        {
+            std::error_code error;
+            std::filesystem::create_directories(dir, error);
+            SaveProgram(program, path, key);
+        }
+        return program;
+    }
+
+    // the objects of the current context, created on its first draw
+    DrawObjects ContextDrawObjects()
+    {
+        RendererState& state = State();
+        void* context        = CurrentContext();
+
+        std::lock_guard<std::mutex> lock(state.draw_objects_mutex);
+        for (const DrawObjects& objects : state.draw_objects)
+        {
+            if (objects.context == context)
+            {
+                return objects;
+            }
+        }
+
+        DrawObjects objects;
+        objects.context = context;
+        glGenVertexArrays(1, &objects.vertex_array);
+        glGenBuffers(1, &objects.vbo);
+        glGenBuffers(1, &objects.ebo);
+
+        // linking from the binary skips compiling the shaders once more
+        if (!state.program_binary.empty())
+        {
+            objects.program = ProgramFromBinary(state.program_binary, state.program_binary_format);
+        }
+        if (objects.program == 0)
+        {
+            objects.program = CompileProgram(false);
+        }
+        objects.loc_texture  = glGetUniformLocation(objects.program, "Texture");
+        objects.loc_proj_mtx = glGetUniformLocation(objects.program, "ProjMtx");
+        objects.loc_position = glGetAttribLocation(objects.program, "Position");
+        objects.loc_uv       = glGetAttribLocation(objects.program, "UV");
+        objects.loc_color    = glGetAttribLocation(objects.program, "Color");
+
+        state.draw_objects.push_back(objects);
+        return objects;
+    }
+
+    void SetupRenderState(ImDrawData* draw_data, int fb_width, int fb_height,
+                          const DrawObjects& objects, bool flip_y)
+    {
+        // alpha blending, no face culling, no depth testing, scissor enabled, polygon fill
+        glEnable(GL_BLEND);
+        glBlendEquation(GL_FUNC_ADD);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glDisable(GL_CULL_FACE);
+        glDisable(GL_DEPTH_TEST);
+        glEnable(GL_SCISSOR_TEST);
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+        // orthographic projection of the visible imgui space, DisplayPos is the top left
+        glViewport(0, 0, fb_width, fb_height);
+        float l                 = draw_data->DisplayPos.x;
+        float r                 = draw_data->DisplayPos.x + draw_data->DisplaySize.x;
+        float t                 = draw_data->DisplayPos.y;
+        float b                 = draw_data->DisplayPos.y + draw_data->DisplaySize.y;
+        if (flip_y)
+        {
+            std::swap(t, b);
+        }
+        const float ortho[4][4] = {
+            {2.f / (r - l), 0.f, 0.f, 0.f},
+            {0.f, 2.f / (t - b), 0.f, 0.f},
+            {0.f, 0.f, -1.f, 0.f},
+            {(r + l) / (l - r), (t + b) / (b - t), 0.f, 1.f},
+        };
+        glUseProgram(objects.program);
+        glUniform1i(objects.loc_texture, 0);
+        glUniformMatrix4fv(objects.loc_proj_mtx, 1, GL_FALSE, &ortho[0][0]);
+
+        glBindVertexArray(objects.vertex_array);
+        glBindBuffer(GL_ARRAY_BUFFER, objects.vbo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, objects.ebo);
+        glEnableVertexAttribArray(objects.loc_position);
+        glEnableVertexAttribArray(objects.loc_uv);
+        glEnableVertexAttribArray(objects.loc_color);
+        glVertexAttribPointer(objects.loc_position, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert),
+                              reinterpret_cast<GLvoid*>(IM_OFFSETOF(ImDrawVert, pos)));
+        glVertexAttribPointer(objects.loc_uv, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert),
+                              reinterpret_cast<GLvoid*>(IM_OFFSETOF(ImDrawVert, uv)));
+        glVertexAttribPointer(objects.loc_color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert),
+                              reinterpret_cast<GLvoid*>(IM_OFFSETOF(ImDrawVert, col)));
+    }
+} // namespace
+
+bool Renderer_Gl3::Init(const char* glsl_version, CurrentContextFn current_context)
+{
+    State().current_context = current_context;
+
+    ImGuiIO& io            = ImGui::GetIO();
+    io.BackendRendererName = "quick_imgui_opengl3";
+
+    // ImDrawCmd::VtxOffset allows large meshes with 16-bit indices, GlExt() must have been loaded
+    if (GlExt().DrawElementsBaseVertex != nullptr)
+    {
+        io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+    }
+
+    State().glsl_version = glsl_version != nullptr ? glsl_version : "#version 130";
+    return true;
+}
+
+void Renderer_Gl3::Shutdown()
+{
+    ReleaseContext();
+    DestroyDeviceObjects();
+}
+
+void Renderer_Gl3::ReleaseContext()
+{
+    RendererState& state = State();
+    void* context        = CurrentContext();
+
+    std::lock_guard<std::mutex> lock(state.draw_objects_mutex);
+    auto it = std::find_if(state.draw_objects.begin(), state.draw_objects.end(),
+                           [&](const DrawObjects& objects) { return objects.context == context; });
+    if (it != state.draw_objects.end())
+    {
+        glDeleteVertexArrays(1, &it->vertex_array);
+        glDeleteBuffers(1, &it->vbo);
+        glDeleteBuffers(1, &it->ebo);
+        glDeleteProgram(it->program);
+        state.draw_objects.erase(it);
+    }
+}
+
+void Renderer_Gl3::NewFrame()
+{
+    if (State().program == 0)
+    {
+        CreateDeviceObjects();
+    }
+}
+
+void Renderer_Gl3::RenderDrawData(ImDrawData* draw_data, bool flip_y)
+{
+    // avoid rendering when minimized, scale coordinates for retina displays
+    int fb_width  = static_cast<int>(draw_data->DisplaySize.x * draw_data->FramebufferScale.x);
+    int fb_height = static_cast<int>(draw_data->DisplaySize.y * draw_data->FramebufferScale.y);
+    if (fb_width <= 0 || fb_height <= 0)
+    {
+        return;
+    }
+
+    // backup the GL state we modify
+    GLint last_active_texture;
+    glGetIntegerv(GL_ACTIVE_TEXTURE, &last_active_texture);
+    glActiveTexture(GL_TEXTURE0);
+    GLint last_program, last_texture, last_array_buffer, last_vertex_array;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &last_program);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &last_array_buffer);
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &last_vertex_array);
+    GLint last_polygon_mode[2], last_viewport[4], last_scissor_box[4];
+    glGetIntegerv(GL_POLYGON_MODE, last_polygon_mode);
+    glGetIntegerv(GL_VIEWPORT, last_viewport);
+    glGetIntegerv(GL_SCISSOR_BOX, last_scissor_box);
+    GLint last_blend_src_rgb, last_blend_dst_rgb, last_blend_src_alpha, last_blend_dst_alpha;
+    GLint last_blend_equation_rgb, last_blend_equation_alpha;
+    glGetIntegerv(GL_BLEND_SRC_RGB, &last_blend_src_rgb);
+    glGetIntegerv(GL_BLEND_DST_RGB, &last_blend_dst_rgb);
+    glGetIntegerv(GL_BLEND_SRC_ALPHA, &last_blend_src_alpha);
+    glGetIntegerv(GL_BLEND_DST_ALPHA, &last_blend_dst_alpha);
+    glGetIntegerv(GL_BLEND_EQUATION_RGB, &last_blend_equation_rgb);
+    glGetIntegerv(GL_BLEND_EQUATION_ALPHA, &last_blend_equation_alpha);
+    GLboolean last_enable_blend        = glIsEnabled(GL_BLEND);
+    GLboolean last_enable_cull_face    = glIsEnabled(GL_CULL_FACE);
+    GLboolean last_enable_depth_test   = glIsEnabled(GL_DEPTH_TEST);
+    GLboolean last_enable_scissor_test = glIsEnabled(GL_SCISSOR_TEST);
+
+    DrawObjects objects = ContextDrawObjects();
+    SetupRenderState(draw_data, fb_width, fb_height, objects, flip_y);
+
+    auto draw_base_vertex = GlExt().DrawElementsBaseVertex;
+
+    // project scissor/clipping rectangles into framebuffer space
+    ImVec2 clip_off   = draw_data->DisplayPos;
+    ImVec2 clip_scale = draw_data->FramebufferScale;
+
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+
+        glBufferData(GL_ARRAY_BUFFER,
+                     static_cast<GLsizeiptr>(cmd_list->VtxBuffer.Size) * sizeof(ImDrawVert),
+                     cmd_list->VtxBuffer.Data, GL_STREAM_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                     static_cast<GLsizeiptr>(cmd_list->IdxBuffer.Size) * sizeof(ImDrawIdx),
+                     cmd_list->IdxBuffer.Data, GL_STREAM_DRAW);
+
+        for (const ImDrawCmd& cmd : cmd_list->CmdBuffer)
+        {
+            if (cmd.UserCallback != nullptr)
+            {
+                if (cmd.UserCallback == ImDrawCallback_ResetRenderState)
+                {
+                    SetupRenderState(draw_data, fb_width, fb_height, objects, flip_y);
+                }
+                else
+                {
+                    cmd.UserCallback(cmd_list, &cmd);
+                }
+                continue;
+            }
+
+            ImVec4 clip_rect = {(cmd.ClipRect.x - clip_off.x) * clip_scale.x,
+                                (cmd.ClipRect.y - clip_off.y) * clip_scale.y,
+                                (cmd.ClipRect.z - clip_off.x) * clip_scale.x,
+                                (cmd.ClipRect.w - clip_off.y) * clip_scale.y};
+            if (clip_rect.x >= fb_width || clip_rect.y >= fb_height || clip_rect.z < 0.f ||
+                clip_rect.w < 0.f)
+            {
+                continue;
+            }
+
+            int scissor_y = static_cast<int>(flip_y ? clip_rect.y : fb_height - clip_rect.w);
+            glScissor(static_cast<int>(clip_rect.x), scissor_y,
+                      static_cast<int>(clip_rect.z - clip_rect.x),
+                      static_cast<int>(clip_rect.w - clip_rect.y));
+            glBindTexture(GL_TEXTURE_2D,
+                          static_cast<GLuint>(reinterpret_cast<intptr_t>(cmd.TextureId)));
+            GLenum index_type   = sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+            const void* indices = reinterpret_cast<void*>(cmd.IdxOffset * sizeof(ImDrawIdx));
+            if (draw_base_vertex != nullptr)
+            {
+                draw_base_vertex(GL_TRIANGLES, static_cast<GLsizei>(cmd.ElemCount), index_type,
+                                 indices, static_cast<GLint>(cmd.VtxOffset));
+            }
+            else
+            {
+                glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(cmd.ElemCount), index_type,
+                               indices);
+            }
+        }
+    }
+
+    // restore the modified GL state
+    glUseProgram(last_program);
+    glBindTexture(GL_TEXTURE_2D, last_texture);
+    glActiveTexture(last_active_texture);
+    glBindVertexArray(last_vertex_array);
+    glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
+    glBlendEquationSeparate(last_blend_equation_rgb, last_blend_equation_alpha);
+    glBlendFuncSeparate(last_blend_src_rgb, last_blend_dst_rgb, last_blend_src_alpha,
+                        last_blend_dst_alpha);
+    last_enable_blend ? glEnable(GL_BLEND) : glDisable(GL_BLEND);
+    last_enable_cull_face ? glEnable(GL_CULL_FACE) : glDisable(GL_CULL_FACE);
+    last_enable_depth_test ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
+    last_enable_scissor_test ? glEnable(GL_SCISSOR_TEST) : glDisable(GL_SCISSOR_TEST);
+    glPolygonMode(GL_FRONT_AND_BACK, last_polygon_mode[0]);
+    glViewport(last_viewport[0], last_viewport[1], last_viewport[2], last_viewport[3]);
+    glScissor(last_scissor_box[0], last_scissor_box[1], last_scissor_box[2], last_scissor_box[3]);
+}
+
+bool Renderer_Gl3::RenderToTexture(ImTextureID texture, ImDrawData* draw_data,
+                                   ImVec4 clear_color)
+{
+    int fb_width  = static_cast<int>(draw_data->DisplaySize.x * draw_data->FramebufferScale.x);
+    int fb_height = static_cast<int>(draw_data->DisplaySize.y * draw_data->FramebufferScale.y);
+
+    GLint last_framebuffer, last_viewport[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &last_framebuffer);
+    glGetIntegerv(GL_VIEWPORT, last_viewport);
+
+    // framebuffers are not shared between contexts either
+    GLuint framebuffer = 0;
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                           static_cast<GLuint>(reinterpret_cast<intptr_t>(texture)), 0);
+
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    if (complete)
+    {
+        GLboolean last_enable_scissor_test = glIsEnabled(GL_SCISSOR_TEST);
+        glDisable(GL_SCISSOR_TEST);
+        glViewport(0, 0, fb_width, fb_height);
+        glClearColor(clear_color.x, clear_color.y, clear_color.z, clear_color.w);
+        glClear(GL_COLOR_BUFFER_BIT);
+        last_enable_scissor_test ? glEnable(GL_SCISSOR_TEST) : glDisable(GL_SCISSOR_TEST);
+
+        // the first row of the texture is the top one, as for uploaded pixels
+        RenderDrawData(draw_data, true);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, last_framebuffer);
+    glDeleteFramebuffers(1, &framebuffer);
+    glViewport(last_viewport[0], last_viewport[1], last_viewport[2], last_viewport[3]);
+    return complete;
+}
+
+void Renderer_Gl3::SetProgramCacheDir(const std::string& dir)
+{
+    State().cache_dir = dir;
+}
+
+bool Renderer_Gl3::ProgramCached()
+{
+    return State().program_cached;
+}
+
+bool Renderer_Gl3::CreateFontsTexture()
+{
+    ImGuiIO& io = ImGui::GetIO();
+    unsigned char* pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    GLint last_texture;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
+
+    GLuint& texture = State().font_texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    io.Fonts->TexID = reinterpret_cast<ImTextureID>(static_cast<intptr_t>(texture));
+
+    glBindTexture(GL_TEXTURE_2D, last_texture);
+    return true;
+}
+
+void Renderer_Gl3::DestroyFontsTexture()
+{
+    GLuint& texture = State().font_texture;
+    if (texture != 0)
+    {
+        glDeleteTextures(1, &texture);
+        ImGui::GetIO().Fonts->TexID = nullptr;
+        texture                     = 0;
+    }
+}
+
+bool Renderer_Gl3::CreateDeviceObjects()
+{
+    RendererState& state = State();
+
+    // backup the GL state we modify
+    GLint last_texture, last_array_buffer, last_vertex_array;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &last_array_buffer);
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &last_vertex_array);
+
+    state.program = CreateProgram(state.program_cached);
+    if (state.program == 0)
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> binary;
+    uint32_t format = 0;
+    if (GlExt().HasProgramBinary())
+    {
+        binary = GetBinary(state.program, format);
+    }
+    {
+        std::lock_guard<std::mutex> lock(state.draw_objects_mutex);
+        state.program_binary.swap(binary);
+        state.program_binary_format = format;
+    }
+
+    CreateFontsTexture();
+
+    glBindTexture(GL_TEXTURE_2D, last_texture);
+    glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
+    glBindVertexArray(last_vertex_array);
+    return true;
+}
+
+void Renderer_Gl3::DestroyDeviceObjects()
+{
+    RendererState& state = State();
+    if (state.program != 0)
+    {
+        glDeleteProgram(state.program);
+        state.program = 0;
+    }
+
+    DestroyFontsTexture();
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "imgui.h"
+#include <string>
+
+// the renderer of the OpenGL3 backends, equivalent to imgui_impl_opengl3 for GLSL 130 and later,
+// whose linked program can be kept in an on-disk cache of program binaries
+//
+// The cache is keyed by the driver's vendor, renderer and version strings and by the shader
+// sources, and a binary the driver rejects, e.g. after an update that kept the version string, is
+// compiled again and replaces the cached one.
+//
+// NOTE every context sharing objects with the one the device objects were created on gets its own
+// program, linked from the binary of the first one if the driver supports program binaries, and
+// its own vertex array and buffers, so RenderDrawData() can be called on any of them, also from
+// different threads
+class Renderer_Gl3
+{
+public:
+    // returns the current GL context, e.g. glfwGetCurrentContext(), to tell contexts apart
+    using CurrentContextFn = void* (*)();
+
+    // `current_context` may be null if the renderer only ever draws on one context
+    static bool Init(const char* glsl_version, CurrentContextFn current_context = nullptr);
+    static void Shutdown();
+
+    // delete the program, vertex array and buffers of the current context, before destroying it
+    static void ReleaseContext();
+
+    static void NewFrame();
+    // `flip_y` renders upside down, i.e. with the top row first in a framebuffer's memory
+    static void RenderDrawData(ImDrawData* draw_data, bool flip_y = false);
+
+    // render into an RGBA texture the size of the draw data's framebuffer, over `clear_color`
+    // returns false if the texture cannot be rendered into
+    static bool RenderToTexture(ImTextureID texture, ImDrawData* draw_data, ImVec4 clear_color);
+
+    // directory for the program binary cache, read by CreateDeviceObjects(), empty disables it
+    static void SetProgramCacheDir(const std::string& dir);
+
+    // whether the current program was loaded from the cache rather than compiled
+    static bool ProgramCached();
+
+    static bool CreateFontsTexture();
+    static void DestroyFontsTexture();
+    static bool CreateDeviceObjects();
+    static void DestroyDeviceObjects();
+};
@@ -0,0 +1,457 @@
+#include "software_rasterizer.h"
+#include "worker_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <utility>
+
+// SSE2 is part of the x86-64 baseline, so the 4-wide path needs no extra compiler flags
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define QUICK_IMGUI_SOFTWARE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    enum Attribute
+    {
+        kU,
+        kV,
+        kR,
+        kG,
+        kB,
+        kA,
+        kAttributeCount
+    };
+
+    const SoftwareTexture* LookupTexture(ImTextureID id)
+    {
+        return static_cast<const SoftwareTexture*>(id);
+    }
+
+    float Channel(uint32_t rgba, int ch)
+    {
+        return static_cast<float>((rgba >> (8 * ch)) & 0xFF);
+    }
+
+    uint32_t SampleNearest(const SoftwareTexture& tex, float u, float v)
+    {
+        int x = std::clamp(static_cast<int>(u * tex.width), 0, tex.width - 1);
+        int y = std::clamp(static_cast<int>(v * tex.height), 0, tex.height - 1);
+        return tex.pixels[static_cast<size_t>(y) * tex.width + x];
+    }
+
+    uint32_t PackColor(float r, float g, float b, float a)
+    {
+        auto to_u8 = [](float x) {
+            return static_cast<uint32_t>(std::clamp(x, 0.f, 255.f) + 0.5f);
+        };
+
+        return to_u8(r) | (to_u8(g) << 8) | (to_u8(b) << 16) | (to_u8(a) << 24);
+    }
+
+#if QUICK_IMGUI_SOFTWARE_SSE2
+    template <int kChannel>
+    __m128 UnpackChannel(__m128i rgba)
+    {
+        return _mm_cvtepi32_ps(
+            _mm_and_si128(_mm_srli_epi32(rgba, 8 * kChannel), _mm_set1_epi32(0xFF)));
+    }
+
+    __m128i PackChannels(__m128 r, __m128 g, __m128 b, __m128 a)
+    {
+        const __m128 lo = _mm_setzero_ps();
+        const __m128 hi = _mm_set1_ps(255.f);
+        auto to_u8      = [&](__m128 x) {
+            return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(x, lo), hi));
+        };
+
+        __m128i result = to_u8(r);
+        result         = _mm_or_si128(result, _mm_slli_epi32(to_u8(g), 8));
+        result         = _mm_or_si128(result, _mm_slli_epi32(to_u8(b), 16));
+        result         = _mm_or_si128(result, _mm_slli_epi32(to_u8(a), 24));
+        return result;
+    }
+#endif
+} // namespace
+
+struct SoftwareRasterizer::Triangle
+{
+    // edge functions ea * x + eb * y + ec, edge i is opposite to vertex i and is non-negative
+    // inside the triangle
+    float ea[3], eb[3], ec[3];
+
+    // pixels exactly on an edge shared by two triangles belong to one of them only
+    bool inclusive[3];
+
+    // attribute planes dx * x + dy * y + c, u and v are in texels
+    float dx[kAttributeCount], dy[kAttributeCount], c[kAttributeCount];
+
+    // pixel bounds, clipped against the clip rect
+    int x0, y0, x1, y1;
+
+    // nullptr when the whole triangle samples a single texel, which is then folded into the
+    // vertex colors. ImGui's solid shapes all sample the font atlas' white pixel.
+    const SoftwareTexture* texture;
+
+    bool Setup(const ImDrawVert* const v[3], const ImVec2& offset, const ImVec2& scale,
+               const SoftwareTexture* tex, const int clip[4])
+    {
+        float x[3], y[3], attr[3][kAttributeCount];
+        for (int i = 0; i < 3; ++i)
+        {
+            x[i]        = (v[i]->pos.x - offset.x) * scale.x;
+            y[i]        = (v[i]->pos.y - offset.y) * scale.y;
+            attr[i][kU] = v[i]->uv.x;
+            attr[i][kV] = v[i]->uv.y;
+            for (int ch = 0; ch < 4; ++ch)
+            {
+                attr[i][kR + ch] = Channel(v[i]->col, ch);
+            }
+        }
+
+        float area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+        if (area == 0.f)
+        {
+            return false;
+        }
+        if (area < 0.f)
+        {
+            std::swap(x[1], x[2]);
+            std::swap(y[1], y[2]);
+            std::swap(attr[1], attr[2]);
+            area = -area;
+        }
+
+        x0 = std::max(clip[0], static_cast<int>(std::floor(std::min({x[0], x[1], x[2]}))));
+        y0 = std::max(clip[1], static_cast<int>(std::floor(std::min({y[0], y[1], y[2]}))));
+        x1 = std::min(clip[2], static_cast<int>(std::ceil(std::max({x[0], x[1], x[2]}))));
+        y1 = std::min(clip[3], static_cast<int>(std::ceil(std::max({y[0], y[1], y[2]}))));
+        if (x0 >= x1 || y0 >= y1)
+        {
+            return false;
+        }
+
+        texture = tex;
+        if (tex == nullptr || (attr[0][kU] == attr[1][kU] && attr[0][kU] == attr[2][kU] &&
+                               attr[0][kV] == attr[1][kV] && attr[0][kV] == attr[2][kV]))
+        {
+            uint32_t texel =
+                tex != nullptr ? SampleNearest(*tex, attr[0][kU], attr[0][kV]) : 0xFFFFFFFF;
+            for (int i = 0; i < 3; ++i)
+            {
+                for (int ch = 0; ch < 4; ++ch)
+                {
+                    attr[i][kR + ch] *= Channel(texel, ch) / 255.f;
+                }
+            }
+
+            texture = nullptr;
+        }
+        else
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                attr[i][kU] *= static_cast<float>(tex->width);
+                attr[i][kV] *= static_cast<float>(tex->height);
+            }
+        }
+
+        for (int i = 0; i < 3; ++i)
+        {
+            int a = (i + 1) % 3;
+            int b = (i + 2) % 3;
+
+            ea[i]        = y[a] - y[b];
+            eb[i]        = x[b] - x[a];
+            ec[i]        = -(ea[i] * x[a] + eb[i] * y[a]);
+            inclusive[i] = ea[i] > 0.f || (ea[i] == 0.f && eb[i] < 0.f);
+        }
+
+        // barycentric weight of vertex i is its edge function divided by the area
+        float inv_area = 1.f / area;
+        for (int k = 0; k < kAttributeCount; ++k)
+        {
+            dx[k] = (ea[0] * attr[0][k] + ea[1] * attr[1][k] + ea[2] * attr[2][k]) * inv_area;
+            dy[k] = (eb[0] * attr[0][k] + eb[1] * attr[1][k] + eb[2] * attr[2][k]) * inv_area;
+            c[k]  = (ec[0] * attr[0][k] + ec[1] * attr[1][k] + ec[2] * attr[2][k]) * inv_area;
+        }
+
+        return true;
+    }
+
+    // rasterize pixels [span_x0, span_x1) of row y with alpha blending
+    void Span(uint32_t* row, int span_x0, int span_x1, int y) const
+    {
+        float py = static_cast<float>(y) + .5f;
+
+        float e_row[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            e_row[i] = eb[i] * py + ec[i];
+        }
+
+        float attr_row[kAttributeCount];
+        for (int k = 0; k < kAttributeCount; ++k)
+        {
+            attr_row[k] = dy[k] * py + c[k];
+        }
+
+#if QUICK_IMGUI_SOFTWARE_SSE2
+        const __m128 zero  = _mm_setzero_ps();
+        const __m128 one   = _mm_set1_ps(1.f);
+        const __m128 norm  = _mm_set1_ps(1.f / 255.f);
+        const __m128 lanes = _mm_setr_ps(.5f, 1.5f, 2.5f, 3.5f);
+        const __m128 left  = _mm_set1_ps(static_cast<float>(span_x0));
+        const __m128 right = _mm_set1_ps(static_cast<float>(span_x1));
+        const __m128 max_u = _mm_set1_ps(texture != nullptr ? texture->width - 1.f : 0.f);
+        const __m128 max_v = _mm_set1_ps(texture != nullptr ? texture->height - 1.f : 0.f);
+
+        // the framebuffer stride is a multiple of 4, so aligning down never leaves the row
+        for (int x = span_x0 & ~3; x < span_x1; x += 4)
+        {
+            __m128 px   = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lanes);
+            __m128 mask = _mm_and_ps(_mm_cmpgt_ps(px, left), _mm_cmplt_ps(px, right));
+            for (int i = 0; i < 3; ++i)
+            {
+                __m128 e = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(ea[i]), px), _mm_set1_ps(e_row[i]));
+                mask     = _mm_and_ps(mask, inclusive[i] ? _mm_cmpge_ps(e, zero)
+                                                         : _mm_cmpgt_ps(e, zero));
+            }
+            if (_mm_movemask_ps(mask) == 0)
+            {
+                continue;
+            }
+
+            auto plane = [&](int k) {
+                return _mm_add_ps(_mm_mul_ps(_mm_set1_ps(dx[k]), px), _mm_set1_ps(attr_row[k]));
+            };
+
+            __m128 r = plane(kR);
+            __m128 g = plane(kG);
+            __m128 b = plane(kB);
+            __m128 a = plane(kA);
+            if (texture != nullptr)
+            {
+                __m128 u = _mm_min_ps(_mm_max_ps(plane(kU), zero), max_u);
+                __m128 v = _mm_min_ps(_mm_max_ps(plane(kV), zero), max_v);
+
+                alignas(16) int32_t tu[4];
+                alignas(16) int32_t tv[4];
+                _mm_store_si128(reinterpret_cast<__m128i*>(tu), _mm_cvttps_epi32(u));
+                _mm_store_si128(reinterpret_cast<__m128i*>(tv), _mm_cvttps_epi32(v));
+
+                const uint32_t* texels = texture->pixels.data();
+                const size_t pitch     = static_cast<size_t>(texture->width);
+                __m128i t              = _mm_setr_epi32(
+                    static_cast<int>(texels[tv[0] * pitch + tu[0]]),
+                    static_cast<int>(texels[tv[1] * pitch + tu[1]]),
+                    static_cast<int>(texels[tv[2] * pitch + tu[2]]),
+                    static_cast<int>(texels[tv[3] * pitch + tu[3]]));
+
+                r = _mm_mul_ps(r, _mm_mul_ps(UnpackChannel<0>(t), norm));
+                g = _mm_mul_ps(g, _mm_mul_ps(UnpackChannel<1>(t), norm));
+                b = _mm_mul_ps(b, _mm_mul_ps(UnpackChannel<2>(t), norm));
+                a = _mm_mul_ps(a, _mm_mul_ps(UnpackChannel<3>(t), norm));
+            }
+
+            // glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA), as in the OpenGL3 renderer
+            __m128i* p  = reinterpret_cast<__m128i*>(row + x);
+            __m128i dst = _mm_loadu_si128(p);
+            __m128 sa   = _mm_mul_ps(a, norm);
+            __m128 da   = _mm_sub_ps(one, sa);
+
+            __m128i out = PackChannels(
+                _mm_add_ps(_mm_mul_ps(r, sa), _mm_mul_ps(UnpackChannel<0>(dst), da)),
+                _mm_add_ps(_mm_mul_ps(g, sa), _mm_mul_ps(UnpackChannel<1>(dst), da)),
+                _mm_add_ps(_mm_mul_ps(b, sa), _mm_mul_ps(UnpackChannel<2>(dst), da)),
+                _mm_add_ps(_mm_mul_ps(a, sa), _mm_mul_ps(UnpackChannel<3>(dst), da)));
+
+            __m128i m = _mm_castps_si128(mask);
+            _mm_storeu_si128(p, _mm_or_si128(_mm_and_si128(m, out), _mm_andnot_si128(m, dst)));
+        }
+#else
+        for (int x = span_x0; x < span_x1; ++x)
+        {
+            float px = static_cast<float>(x) + .5f;
+
+            bool inside = true;
+            for (int i = 0; i < 3 && inside; ++i)
+            {
+                float e = ea[i] * px + e_row[i];
+                inside  = inclusive[i] ? e >= 0.f : e > 0.f;
+            }
+            if (!inside)
+            {
+                continue;
+            }
+
+            float src[4];
+            for (int ch = 0; ch < 4; ++ch)
+            {
+                src[ch] = dx[kR + ch] * px + attr_row[kR + ch];
+            }
+            if (texture != nullptr)
+            {
+                float u = dx[kU] * px + attr_row[kU];
+                float v = dx[kV] * px + attr_row[kV];
+
+                uint32_t texel = SampleNearest(*texture, u / texture->width, v / texture->height);
+                for (int ch = 0; ch < 4; ++ch)
+                {
+                    src[ch] *= Channel(texel, ch) / 255.f;
+                }
+            }
+
+            // glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA), as in the OpenGL3 renderer
+            float sa = src[3] / 255.f;
+            float da = 1.f - sa;
+            row[x]   = PackColor(src[0] * sa + Channel(row[x], 0) * da,
+                               src[1] * sa + Channel(row[x], 1) * da,
+                               src[2] * sa + Channel(row[x], 2) * da,
+                               src[3] * sa + Channel(row[x], 3) * da);
+        }
+#endif
+    }
+};
+
+SoftwareRasterizer::SoftwareRasterizer(int num_threads)
+{
+    if (num_threads <= 0)
+    {
+        num_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    workers_ = std::make_unique<WorkerPool>(num_threads - 1);
+}
+
+SoftwareRasterizer::~SoftwareRasterizer() = default;
+
+void SoftwareRasterizer::Resize(int width, int height)
+{
+    width  = std::max(width, 0);
+    height = std::max(height, 0);
+    if (width == width_ && height == height_)
+    {
+        return;
+    }
+
+    width_   = width;
+    height_  = height;
+    stride_  = (width + 3) & ~3;
+    tiles_x_ = (width + kTileSize - 1) / kTileSize;
+    tiles_y_ = (height + kTileSize - 1) / kTileSize;
+
+    pixels_.assign(static_cast<size_t>(stride_) * height_, 0);
+    bins_.resize(static_cast<size_t>(tiles_x_) * tiles_y_);
+}
+
+void SoftwareRasterizer::Clear(ImVec4 color)
+{
+    std::fill(pixels_.begin(), pixels_.end(),
+              PackColor(color.x * 255.f, color.y * 255.f, color.z * 255.f, color.w * 255.f));
+}
+
+void SoftwareRasterizer::RenderDrawData(const ImDrawData* draw_data)
+{
+    if (draw_data == nullptr || width_ == 0 || height_ == 0)
+    {
+        return;
+    }
+
+    BinTriangles(draw_data);
+    workers_->ParallelFor(static_cast<int>(bins_.size()), [this](int i) { RasterizeTile(i); });
+}
+
+void SoftwareRasterizer::BinTriangles(const ImDrawData* draw_data)
+{
+    triangles_.clear();
+    for (auto& bin : bins_)
+    {
+        bin.clear();
+    }
+
+    // Project scissor/clipping rectangles into framebuffer space
+    ImVec2 clip_off   = draw_data->DisplayPos;
+    ImVec2 clip_scale = draw_data->FramebufferScale;
+
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        const ImDrawVert* vtx      = cmd_list->VtxBuffer.Data;
+        const ImDrawIdx* idx       = cmd_list->IdxBuffer.Data;
+
+        for (const ImDrawCmd& cmd : cmd_list->CmdBuffer)
+        {
+            if (cmd.UserCallback != NULL)
+            {
+                // There is no render state to reset
+                if (cmd.UserCallback != ImDrawCallback_ResetRenderState)
+                {
+                    cmd.UserCallback(cmd_list, &cmd);
+                }
+                continue;
+            }
+
+            int clip[4] = {
+                std::max(0, static_cast<int>((cmd.ClipRect.x - clip_off.x) * clip_scale.x)),
+                std::max(0, static_cast<int>((cmd.ClipRect.y - clip_off.y) * clip_scale.y)),
+                std::min(width_, static_cast<int>((cmd.ClipRect.z - clip_off.x) * clip_scale.x)),
+                std::min(height_, static_cast<int>((cmd.ClipRect.w - clip_off.y) * clip_scale.y)),
+            };
+            if (clip[0] >= clip[2] || clip[1] >= clip[3])
+            {
+                continue;
+            }
+
+            const SoftwareTexture* texture = LookupTexture(cmd.TextureId);
+            for (unsigned int i = 0; i + 2 < cmd.ElemCount; i += 3)
+            {
+                const ImDrawIdx* tri_idx   = idx + cmd.IdxOffset + i;
+                const ImDrawVert* verts[3] = {&vtx[cmd.VtxOffset + tri_idx[0]],
+                                              &vtx[cmd.VtxOffset + tri_idx[1]],
+                                              &vtx[cmd.VtxOffset + tri_idx[2]]};
+
+                Triangle tri;
+                if (!tri.Setup(verts, clip_off, clip_scale, texture, clip))
+                {
+                    continue;
+                }
+
+                auto tri_index = static_cast<uint32_t>(triangles_.size());
+                triangles_.push_back(tri);
+
+                for (int ty = tri.y0 / kTileSize; ty <= (tri.y1 - 1) / kTileSize; ++ty)
+                {
+                    for (int tx = tri.x0 / kTileSize; tx <= (tri.x1 - 1) / kTileSize; ++tx)
+                    {
+                        bins_[ty * tiles_x_ + tx].push_back(tri_index);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void SoftwareRasterizer::RasterizeTile(int tile_index)
+{
+    int tile_x0 = (tile_index % tiles_x_) * kTileSize;
+    int tile_y0 = (tile_index / tiles_x_) * kTileSize;
+    int tile_x1 = std::min(tile_x0 + kTileSize, width_);
+    int tile_y1 = std::min(tile_y0 + kTileSize, height_);
+
+    // Triangles are stored in submission order, so blending within a tile stays correct
+    for (uint32_t tri_index : bins_[tile_index])
+    {
+        const Triangle& tri = triangles_[tri_index];
+
+        int x0 = std::max(tri.x0, tile_x0);
+        int x1 = std::min(tri.x1, tile_x1);
+        int y0 = std::max(tri.y0, tile_y0);
+        int y1 = std::min(tri.y1, tile_y1);
+        for (int y = y0; y < y1; ++y)
+        {
+            tri.Span(&pixels_[static_cast<size_t>(y) * stride_], x0, x1, y);
+        }
+    }
+}
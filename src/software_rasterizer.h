@@ -0,0 +1,70 @@
+#pragma once
+#include "imgui.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class WorkerPool;
+
+// CPU-side texture, pixels are RGBA8 with R in the lowest byte (the same layout as ImU32)
+struct SoftwareTexture
+{
+    int width  = 0;
+    int height = 0;
+    std::vector<uint32_t> pixels;
+};
+
+// renders ImDrawData into an in-memory RGBA8 framebuffer
+//
+// Triangles are binned into fixed-size screen tiles, which are then rasterized in parallel. An
+// ImTextureID is expected to point to a SoftwareTexture, nullptr samples as opaque white.
+class SoftwareRasterizer
+{
+public:
+    static constexpr int kTileSize = 64;
+
+    // num_threads <= 0 uses all hardware threads
+    explicit SoftwareRasterizer(int num_threads = 0);
+    ~SoftwareRasterizer();
+
+    void Resize(int width, int height);
+    void Clear(ImVec4 color);
+    void RenderDrawData(const ImDrawData* draw_data);
+
+    const uint32_t* Pixels() const
+    {
+        return pixels_.data();
+    }
+    int Width() const
+    {
+        return width_;
+    }
+    int Height() const
+    {
+        return height_;
+    }
+    // in pixels, rows are padded so that the SIMD path never reads past the end of a row
+    int Stride() const
+    {
+        return stride_;
+    }
+
+private:
+    struct Triangle;
+
+    void BinTriangles(const ImDrawData* draw_data);
+    void RasterizeTile(int tile_index);
+
+    int width_   = 0;
+    int height_  = 0;
+    int stride_  = 0;
+    int tiles_x_ = 0;
+    int tiles_y_ = 0;
+    std::vector<uint32_t> pixels_;
+
+    // reused across frames so that steady state does not allocate
+    std::vector<Triangle> triangles_;
+    std::vector<std::vector<uint32_t>> bins_;
+
+    std::unique_ptr<WorkerPool> workers_;
+};
@@ -0,0 +1,466 @@
+// shared by the OpenGL3 backends, an OpenGL loader must have been included before this header
+
+#pragma once
+#include "gl_ext.h"
+#include "platform.h"
+#include "texture_memory.h"
+#include "texture_pool.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+class PlatformTexture_Gl3 final : public PlatformTexture
+{
+private:
+    // uploads cycle through this many pixel buffers, so that writing the next frame does not wait
+    // for the GPU to consume the previous ones
+    static constexpr int kRingSize = 3;
+
+    struct StagingBuffer
+    {
+        GLuint pbo   = 0;
+        size_t size  = 0;
+        GLsync fence = nullptr; // signaled once the texture has been updated from `pbo`
+    };
+
+    struct GlFormat
+    {
+        GLint internal_format;
+        GLenum format;
+        GLenum type;
+    };
+
+    GLuint tex_          = 0;
+    GlFormat gl_format_  = {};
+    int bytes_per_pixel_ = 4;
+
+    // created on the second upload, textures that are written once never use them
+    StagingBuffer ring_[kRingSize];
+    int next_staging_ = 0;
+    uint64_t uploads_ = 0;
+
+    // everything a recycled texture takes over from a released one
+    struct Resources
+    {
+        GLuint tex = 0;
+        StagingBuffer ring[kRingSize];
+        int next_staging = 0;
+        uint64_t uploads = 0;
+    };
+
+    inline static PlatformTextureStats stats_;
+
+public:
+    static const PlatformTextureStats& Stats()
+    {
+        return stats_;
+    }
+
+    // the contents were rendered into, which invalidates retained frames just like an upload
+    static void CountRender()
+    {
+        stats_.uploads += 1;
+    }
+
+    static void SetPoolCapacity(size_t bytes)
+    {
+        Pool().SetCapacity(bytes);
+    }
+
+    // must be called while the context is still current
+    static void ClearPool()
+    {
+        Pool().Clear();
+    }
+
+    PlatformTexture_Gl3() = default;
+    ~PlatformTexture_Gl3() override
+    {
+        Cleanup();
+    }
+
+    bool Initialize(int width, int height, TextureFormat format)
+    {
+        gl_format_       = ToGlFormat(format);
+        bytes_per_pixel_ = BytesPerPixel(format);
+
+        width_  = width;
+        height_ = height;
+        format_ = format;
+
+        // a recycled texture keeps its storage, parameters and staging buffers, which all depend
+        // on size and format only
+        Resources recycled;
+        if (Pool().Acquire(width, height, format, &recycled))
+        {
+            Adopt(std::move(recycled));
+            TextureMemory::Get().Track(this, StorageBytes());
+            return true;
+        }
+
+        GLuint tex;
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        // imgui's shader multiplies with all four channels, so single channel textures are
+        // swizzled to grayscale. Without texture swizzle support they show up red.
+        const GLint* swizzle = Swizzle(format);
+        if (swizzle != nullptr && GlExt().TextureSwizzle)
+        {
+            glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+        }
+
+        glTexImage2D(GL_TEXTURE_2D, 0, gl_format_.internal_format, width, height, 0,
+                     gl_format_.format, gl_format_.type, nullptr);
+
+        id_  = reinterpret_cast<ImTextureID>((uintptr_t)tex);
+        tex_ = tex;
+        TextureMemory::Get().Track(this, StorageBytes());
+        return true;
+    }
+
+    virtual void UpdateRgba(const void* p) override
+    {
+        IM_ASSERT(Format() == TextureFormat::Rgba8 && "use UpdatePixels() for other formats");
+        UpdatePixels(p);
+    }
+
+    virtual void UpdateRegion(int x, int y, int width, int height, const void* p,
+                              int row_stride) override
+    {
+        IM_ASSERT(x >= 0 && y >= 0 && x + width <= width_ && y + height <= height_);
+        if (width <= 0 || height <= 0)
+        {
+            return;
+        }
+
+        TextureMemory::Get().Restore(*this);
+        stats_.uploads += 1;
+        uploads_ += 1;
+
+        size_t packed_pitch = static_cast<size_t>(width) * bytes_per_pixel_;
+        void* dst           = uploads_ > 1 ? MapStaging(packed_pitch * height) : nullptr;
+        if (dst == nullptr)
+        {
+            glBindTexture(GL_TEXTURE_2D, tex_);
+            if (row_stride % bytes_per_pixel_ == 0)
+            {
+                glPixelStorei(GL_UNPACK_ROW_LENGTH, row_stride / bytes_per_pixel_);
+                TexSubImage(x, y, width, height, p);
+                glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+            }
+            else
+            {
+                // GL_UNPACK_ROW_LENGTH counts whole pixels
+                for (int row = 0; row < height; ++row)
+                {
+                    TexSubImage(x, y + row, width, 1,
+                                static_cast<const uint8_t*>(p) + row * row_stride);
+                }
+            }
+            return;
+        }
+
+        // pack the rows, so that the staging buffer only holds the region
+        if (static_cast<size_t>(row_stride) == packed_pitch)
+        {
+            memcpy(dst, p, packed_pitch * height);
+        }
+        else
+        {
+            for (int row = 0; row < height; ++row)
+            {
+                memcpy(static_cast<uint8_t*>(dst) + row * packed_pitch,
+                       static_cast<const uint8_t*>(p) + row * row_stride, packed_pitch);
+            }
+        }
+        UnmapStaging(x, y, width, height);
+    }
+
+    virtual void Update(std::function<void(void* p, int row_pitch)> f) override
+    {
+        TextureMemory::Get().Restore(*this);
+        stats_.uploads += 1;
+        uploads_ += 1;
+
+        int row_pitch = width_ * bytes_per_pixel_;
+        size_t size   = static_cast<size_t>(row_pitch) * height_;
+        void* dst     = MapStaging(size);
+        if (dst == nullptr)
+        {
+            std::vector<uint8_t> pixels(size);
+            f(pixels.data(), row_pitch);
+
+            glBindTexture(GL_TEXTURE_2D, tex_);
+            TexSubImage(0, 0, width_, height_, pixels.data());
+            return;
+        }
+
+        try
+        {
+            f(dst, row_pitch);
+        }
+        catch (...)
+        {
+            // the texture keeps its previous contents
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            throw;
+        }
+
+        UnmapStaging(0, 0, width_, height_);
+    }
+
+    virtual bool IsUploadComplete() override
+    {
+        // NOTE without GL_ARB_sync there are no fences, and uploads are reported as complete
+        for (const auto& staging : ring_)
+        {
+            if (IsPending(staging))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // hands the texture over to the pool
+    void Cleanup()
+    {
+        if (tex_ != 0)
+        {
+            TextureMemory::Get().Untrack(this);
+
+            Resources resources;
+            resources.tex          = tex_;
+            resources.next_staging = next_staging_;
+            resources.uploads      = uploads_;
+
+            size_t bytes = StorageBytes();
+            for (int i = 0; i < kRingSize; ++i)
+            {
+                resources.ring[i] = ring_[i];
+                bytes += ring_[i].size;
+                ring_[i] = {};
+            }
+
+            // there is no storage to reuse in an evicted texture
+            if (evicted_)
+            {
+                DestroyResources(resources);
+            }
+            else
+            {
+                Pool().Release(width_, height_, format_, bytes, resources);
+            }
+            tex_ = 0;
+        }
+
+        Clear();
+    }
+
+protected:
+    virtual bool EvictStorage() override
+    {
+        // a zero sized image releases the storage but keeps the name and parameters, the
+        // staging buffers go as well
+        glBindTexture(GL_TEXTURE_2D, tex_);
+        glTexImage2D(GL_TEXTURE_2D, 0, gl_format_.internal_format, 0, 0, 0, gl_format_.format,
+                     gl_format_.type, nullptr);
+
+        Resources staging;
+        for (int i = 0; i < kRingSize; ++i)
+        {
+            staging.ring[i] = ring_[i];
+            ring_[i]        = {};
+        }
+        DestroyResources(staging);
+        uploads_ = 0;
+        return true;
+    }
+
+    virtual void RestoreStorage() override
+    {
+        glBindTexture(GL_TEXTURE_2D, tex_);
+        glTexImage2D(GL_TEXTURE_2D, 0, gl_format_.internal_format, width_, height_, 0,
+                     gl_format_.format, gl_format_.type, nullptr);
+    }
+
+private:
+    size_t StorageBytes() const
+    {
+        return static_cast<size_t>(width_) * height_ * bytes_per_pixel_;
+    }
+
+    static TexturePool<Resources>& Pool()
+    {
+        static TexturePool<Resources> pool{&DestroyResources, &stats_};
+        return pool;
+    }
+
+    void Adopt(Resources&& resources)
+    {
+        tex_          = resources.tex;
+        next_staging_ = resources.next_staging;
+        uploads_      = resources.uploads;
+        for (int i = 0; i < kRingSize; ++i)
+        {
+            ring_[i] = resources.ring[i];
+        }
+        id_ = reinterpret_cast<ImTextureID>((uintptr_t)tex_);
+    }
+
+    static void DestroyResources(Resources& resources)
+    {
+        for (auto& staging : resources.ring)
+        {
+            DeleteFence(staging);
+            if (staging.pbo != 0)
+            {
+                glDeleteBuffers(1, &staging.pbo);
+                staging.pbo  = 0;
+                staging.size = 0;
+            }
+        }
+
+        glDeleteTextures(1, &resources.tex);
+        resources.tex = 0;
+    }
+
+    // map the next pixel buffer of the ring for writing `size` bytes, leaving it bound to
+    // GL_PIXEL_UNPACK_BUFFER, returns nullptr if mapping failed
+    void* MapStaging(size_t size)
+    {
+        StagingBuffer& staging = ring_[next_staging_];
+
+        bool previous_in_flight   = false;
+        bool reuse_unsynchronized = false;
+        if (GlExt().HasSync())
+        {
+            const StagingBuffer& previous = ring_[(next_staging_ + kRingSize - 1) % kRingSize];
+            previous_in_flight            = IsPending(previous);
+
+            // the storage must be large enough and no longer read by the GPU
+            reuse_unsynchronized = staging.size >= size && !IsPending(staging);
+        }
+
+        if (staging.pbo == 0)
+        {
+            glGenBuffers(1, &staging.pbo);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging.pbo);
+
+        GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+        if (reuse_unsynchronized)
+        {
+            access |= GL_MAP_UNSYNCHRONIZED_BIT;
+        }
+        else
+        {
+            // Orphan the storage, the driver hands out a fresh one if the GPU still reads the
+            // old one instead of blocking
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+            staging.size = size;
+        }
+
+        void* result = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, access);
+        if (result == nullptr)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            return nullptr;
+        }
+
+        stats_.async_uploads += 1;
+        if (previous_in_flight)
+        {
+            stats_.stalls_avoided += 1;
+        }
+        return result;
+    }
+
+    // copy the mapped pixel buffer into the given region of the texture and fence it, the rows
+    // in the buffer are tightly packed
+    void UnmapStaging(int x, int y, int width, int height)
+    {
+        StagingBuffer& staging = ring_[next_staging_];
+        next_staging_          = (next_staging_ + 1) % kRingSize;
+
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindTexture(GL_TEXTURE_2D, tex_);
+        TexSubImage(x, y, width, height, nullptr);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        DeleteFence(staging);
+        if (GlExt().HasSync())
+        {
+            staging.fence = GlExt().FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+    }
+
+    // upload into the bound texture, rows are packed without padding
+    void TexSubImage(int x, int y, int width, int height, const void* p)
+    {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, gl_format_.format,
+                        gl_format_.type, p);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+
+    static GlFormat ToGlFormat(TextureFormat format)
+    {
+        switch (format)
+        {
+        case TextureFormat::Bgra8:
+            return {GL_RGBA8, GL_BGRA, GL_UNSIGNED_BYTE};
+        case TextureFormat::R8:
+            return {GL_R8, GL_RED, GL_UNSIGNED_BYTE};
+        case TextureFormat::Rg8:
+            return {GL_RG8, GL_RG, GL_UNSIGNED_BYTE};
+        case TextureFormat::R16F:
+            return {GL_R16F, GL_RED, GL_HALF_FLOAT};
+        case TextureFormat::R32F:
+            return {GL_R32F, GL_RED, GL_FLOAT};
+        case TextureFormat::Rgb565:
+            // GL_RGB565 is only core since 4.1, the driver picks a matching format
+            return {GL_RGB, GL_RGB, GL_UNSIGNED_SHORT_5_6_5};
+        default:
+            return {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE};
+        }
+    }
+
+    static const GLint* Swizzle(TextureFormat format)
+    {
+        static const GLint kGray[]      = {GL_RED, GL_RED, GL_RED, GL_ONE};
+        static const GLint kGrayAlpha[] = {GL_RED, GL_RED, GL_RED, GL_GREEN};
+
+        switch (format)
+        {
+        case TextureFormat::R8:
+        case TextureFormat::R16F:
+        case TextureFormat::R32F:
+            return kGray;
+        case TextureFormat::Rg8:
+            return kGrayAlpha;
+        default:
+            return nullptr;
+        }
+    }
+
+    static bool IsPending(const StagingBuffer& staging)
+    {
+        return staging.fence != nullptr &&
+               GlExt().ClientWaitSync(staging.fence, 0, 0) == GL_TIMEOUT_EXPIRED;
+    }
+
+    static void DeleteFence(StagingBuffer& staging)
+    {
+        if (staging.fence != nullptr)
+        {
+            GlExt().DeleteSync(staging.fence);
+            staging.fence = nullptr;
+        }
+    }
+};
@@ -0,0 +1,197 @@
+#include "texture_loader.h"
+#include <algorithm>
+#include <cstdio>
+
+#if __has_include("stb_image.h")
+#define QUICK_IMGUI_HAS_STB_IMAGE
+#define STB_IMAGE_STATIC
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#endif
+
+bool DecodeImageFile(const std::string& path, DecodedImage& image)
+{
+#ifdef QUICK_IMGUI_HAS_STB_IMAGE
+    int width, height, channels;
+    stbi_uc* pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+    if (pixels == nullptr)
+    {
+        fprintf(stderr, "failed to decode %s: %s\n", path.c_str(), stbi_failure_reason());
+        return false;
+    }
+
+    image.width  = width;
+    image.height = height;
+    image.format = TextureFormat::Rgba8;
+    image.pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(pixels);
+    return true;
+#else
+    (void)image;
+    fprintf(stderr, "failed to decode %s: built without stb_image\n", path.c_str());
+    return false;
+#endif
+}
+
+TextureLoader::TextureLoader(TextureLoaderConfig config) : config_(std::move(config))
+{
+    int worker_count = config_.worker_count;
+    if (worker_count <= 0)
+    {
+        worker_count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    }
+
+    for (int i = 0; i < worker_count; ++i)
+    {
+        workers_.emplace_back([this] { Work(); });
+    }
+}
+
+TextureLoader::~TextureLoader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+
+    for (auto& worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+TextureLoader::Ptr TextureLoader::Load(const std::string& path)
+{
+    return Load(path, [decoder = config_.decoder, path](DecodedImage& image) {
+        return decoder(path, image);
+    });
+}
+
+TextureLoader::Ptr TextureLoader::Load(const std::string& name,
+                                       std::function<bool(DecodedImage& image)> decode)
+{
+    auto request          = std::make_shared<TextureRequest>();
+    request->path_        = name;
+    request->placeholder_ = Placeholder();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back({request, std::move(decode)});
+    }
+    wake_.notify_one();
+
+    return request;
+}
+
+bool TextureLoader::Update()
+{
+    size_t uploaded = 0;
+    while (true)
+    {
+        Decoded decoded;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (decoded_.empty())
+            {
+                return false;
+            }
+
+            // the first image always goes, however large
+            size_t bytes = decoded_.front().image.pixels.size();
+            if (uploaded > 0 && uploaded + bytes > config_.upload_bytes_per_frame)
+            {
+                return true;
+            }
+
+            decoded = std::move(decoded_.front());
+            decoded_.pop_front();
+        }
+
+        auto request = decoded.request.lock();
+        if (request == nullptr)
+        {
+            continue;
+        }
+
+        const DecodedImage& image = decoded.image;
+        if (decoded.ok)
+        {
+            request->texture_ = AllocateTexture(image.width, image.height, image.format);
+        }
+
+        if (request->texture_ == nullptr)
+        {
+            request->state_ = TextureRequest::State::Failed;
+            continue;
+        }
+
+        request->texture_->UpdatePixels(image.pixels.data());
+        request->state_ = TextureRequest::State::Ready;
+        uploaded += image.pixels.size();
+    }
+}
+
+ImTextureID TextureLoader::Placeholder()
+{
+    if (placeholder_ == nullptr)
+    {
+        placeholder_ = AllocateTexture(2, 2);
+        if (placeholder_ == nullptr)
+        {
+            return nullptr;
+        }
+
+        const uint32_t gray[] = {0xFF808080, 0xFF808080, 0xFF808080, 0xFF808080};
+        placeholder_->UpdateRgba(gray);
+    }
+
+    return placeholder_->Id();
+}
+
+int TextureLoader::PendingCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<int>(jobs_.size() + decoded_.size()) + decoding_;
+}
+
+void TextureLoader::Work()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        wake_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+        if (stopping_)
+        {
+            return;
+        }
+
+        Job job = std::move(jobs_.back());
+        jobs_.pop_back();
+
+        // nobody is waiting for it anymore
+        if (job.request.expired())
+        {
+            continue;
+        }
+
+        decoding_ += 1;
+        lock.unlock();
+
+        Decoded decoded;
+        decoded.request = std::move(job.request);
+        decoded.ok =
+            job.decode(decoded.image) && decoded.image.width > 0 && decoded.image.height > 0;
+
+        lock.lock();
+        decoding_ -= 1;
+        decoded_.push_back(std::move(decoded));
+
+        if (config_.on_decoded)
+        {
+            lock.unlock();
+            config_.on_decoded();
+            lock.lock();
+        }
+    }
+}
@@ -0,0 +1,164 @@
+#pragma once
+#include "imgui.h"
+#include "platform.h"
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// accounts the storage of every live PlatformTexture, and evicts evictable textures least
+// recently drawn first while the total is over budget
+//
+// Textures register themselves when they are created and unregister when they are destroyed.
+// The backend calls Update() with every frame's draw data before rendering it, which records
+// which textures are drawn and brings evicted ones back.
+// NOTE only used on the thread that owns the device
+class TextureMemory
+{
+public:
+    static TextureMemory& Get()
+    {
+        static TextureMemory memory;
+        return memory;
+    }
+
+    const TextureMemoryStats& Stats() const
+    {
+        return stats_;
+    }
+
+    // 0 means unlimited
+    void SetBudget(size_t bytes)
+    {
+        stats_.budget_bytes = bytes;
+        Enforce();
+    }
+
+    void Track(PlatformTexture* texture, size_t bytes)
+    {
+        textures_[texture->id_] = {texture, bytes, CurrentFrame()};
+        Add(bytes);
+        Enforce();
+    }
+
+    void Untrack(PlatformTexture* texture)
+    {
+        auto it = textures_.find(texture->id_);
+        if (it == textures_.end())
+        {
+            return;
+        }
+
+        if (!texture->evicted_)
+        {
+            stats_.current_bytes -= it->second.bytes;
+        }
+        textures_.erase(it);
+    }
+
+    // mark the textures referenced by `draw_data` as used in this frame and restore the evicted
+    // ones among them, then evict down to the budget
+    void Update(const ImDrawData* draw_data)
+    {
+        int frame           = CurrentFrame();
+        ImTextureID last_id = nullptr;
+        for (int i = 0; i < draw_data->CmdListsCount; ++i)
+        {
+            for (const ImDrawCmd& cmd : draw_data->CmdLists[i]->CmdBuffer)
+            {
+                // consecutive commands mostly share a texture
+                if (cmd.TextureId == last_id)
+                {
+                    continue;
+                }
+                last_id = cmd.TextureId;
+
+                auto it = textures_.find(cmd.TextureId);
+                if (it != textures_.end())
+                {
+                    it->second.last_used_frame = frame;
+                    Restore(*it->second.texture);
+                }
+            }
+        }
+
+        Enforce();
+    }
+
+    // reallocate the storage of an evicted texture and let its owner upload the pixels again
+    void Restore(PlatformTexture& texture)
+    {
+        if (!texture.evicted_)
+        {
+            return;
+        }
+
+        texture.RestoreStorage();
+        texture.evicted_ = false;
+        Add(textures_[texture.id_].bytes);
+        stats_.restorations += 1;
+
+        texture.restore_(texture);
+    }
+
+private:
+    struct Record
+    {
+        PlatformTexture* texture;
+        size_t bytes;
+        int last_used_frame;
+    };
+
+    // textures may be created before imgui is
+    static int CurrentFrame()
+    {
+        return ImGui::GetCurrentContext() != nullptr ? ImGui::GetFrameCount() : 0;
+    }
+
+    void Add(size_t bytes)
+    {
+        stats_.current_bytes += bytes;
+        stats_.peak_bytes = std::max(stats_.peak_bytes, stats_.current_bytes);
+    }
+
+    void Enforce()
+    {
+        if (stats_.budget_bytes == 0 || stats_.current_bytes <= stats_.budget_bytes)
+        {
+            return;
+        }
+
+        // textures drawn in this frame are about to be rendered and cannot go, neither can those
+        // of the previous frame, which the pipelined renderer may still be drawing
+        int frame = CurrentFrame() - 1;
+        std::vector<std::pair<int, Record*>> candidates;
+        for (auto& [id, record] : textures_)
+        {
+            PlatformTexture* texture = record.texture;
+            if (texture->restore_ && !texture->evicted_ && record.last_used_frame < frame)
+            {
+                candidates.emplace_back(record.last_used_frame, &record);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        for (auto& [last_used_frame, record] : candidates)
+        {
+            if (stats_.current_bytes <= stats_.budget_bytes)
+            {
+                break;
+            }
+
+            if (record->texture->EvictStorage())
+            {
+                record->texture->evicted_ = true;
+                stats_.current_bytes -= record->bytes;
+                stats_.evictions += 1;
+            }
+        }
+    }
+
+    std::unordered_map<ImTextureID, Record> textures_;
+    TextureMemoryStats stats_;
+};
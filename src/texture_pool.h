@@ -0,0 +1,104 @@
+#pragma once
+#include "platform.h"
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// keeps the backend resources of released textures, so that AllocateTexture can hand them to the
+// next texture of the same size and format instead of asking the driver for new ones
+//
+// Released resources are dropped oldest first once they exceed the capacity.
+// NOTE the pool never destroys resources on its own destruction, backends call Clear() while the
+// device is still alive
+template <typename Resources>
+class TexturePool
+{
+public:
+    using DestroyFn = void (*)(Resources&);
+
+    static constexpr size_t kDefaultCapacity = 64 << 20;
+
+    TexturePool(DestroyFn destroy, PlatformTextureStats* stats) : destroy_(destroy), stats_(stats)
+    {
+    }
+
+    // take the most recently released resources of this size and format, returns false on a miss
+    bool Acquire(int width, int height, TextureFormat format, Resources* out)
+    {
+        for (size_t i = entries_.size(); i-- > 0;)
+        {
+            Entry& entry = entries_[i];
+            if (entry.width == width && entry.height == height && entry.format == format)
+            {
+                *out = std::move(entry.resources);
+                bytes_ -= entry.bytes;
+                entries_.erase(entries_.begin() + i);
+
+                stats_->pool_hits += 1;
+                stats_->pooled_bytes = bytes_;
+                return true;
+            }
+        }
+
+        stats_->pool_misses += 1;
+        return false;
+    }
+
+    // keep the resources of a destroyed texture, `bytes` is what they occupy on the device
+    void Release(int width, int height, TextureFormat format, size_t bytes, Resources resources)
+    {
+        if (bytes > capacity_)
+        {
+            destroy_(resources);
+            return;
+        }
+
+        entries_.push_back({width, height, format, bytes, std::move(resources)});
+        bytes_ += bytes;
+        Trim();
+    }
+
+    void SetCapacity(size_t bytes)
+    {
+        capacity_ = bytes;
+        Trim();
+    }
+
+    // destroy everything, textures released afterwards are destroyed right away
+    void Clear()
+    {
+        SetCapacity(0);
+    }
+
+private:
+    struct Entry
+    {
+        int width;
+        int height;
+        TextureFormat format;
+        size_t bytes;
+        Resources resources;
+    };
+
+    void Trim()
+    {
+        size_t dropped = 0;
+        while (bytes_ > capacity_)
+        {
+            Entry& oldest = entries_[dropped++];
+            destroy_(oldest.resources);
+            bytes_ -= oldest.bytes;
+        }
+        entries_.erase(entries_.begin(), entries_.begin() + dropped);
+
+        stats_->pooled_bytes = bytes_;
+    }
+
+    DestroyFn destroy_;
+    PlatformTextureStats* stats_;
+
+    // oldest first
+    std::vector<Entry> entries_;
+    size_t bytes_    = 0;
+    size_t capacity_ = kDefaultCapacity;
+};
@@ -0,0 +1,306 @@
+#include "tiled_image_view.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    uint8_t* Texel(DecodedImage& image, int x, int y)
+    {
+        return &image.pixels[(static_cast<size_t>(y) * image.width + x) * 4];
+    }
+} // namespace
+
+int TileSource::LevelCount() const
+{
+    int count = 1;
+    while (std::max(LevelWidth(count - 1), LevelHeight(count - 1)) > TileSize())
+    {
+        count += 1;
+    }
+    return count;
+}
+
+int TileSource::LevelWidth(int level) const
+{
+    int width = Width();
+    for (int i = 0; i < level; ++i)
+    {
+        width = (width + 1) / 2;
+    }
+    return width;
+}
+
+int TileSource::LevelHeight(int level) const
+{
+    int height = Height();
+    for (int i = 0; i < level; ++i)
+    {
+        height = (height + 1) / 2;
+    }
+    return height;
+}
+
+int TileSource::TilesX(int level) const
+{
+    return (LevelWidth(level) + TileSize() - 1) / TileSize();
+}
+
+int TileSource::TilesY(int level) const
+{
+    return (LevelHeight(level) + TileSize() - 1) / TileSize();
+}
+
+bool DownsampleTile(TileSource& source, int level, int x, int y, DecodedImage& tile)
+{
+    int tile_size = source.TileSize();
+    IM_ASSERT(level > 0 && tile_size % 2 == 0);
+
+    tile.width  = std::min(tile_size, source.LevelWidth(level) - x * tile_size);
+    tile.height = std::min(tile_size, source.LevelHeight(level) - y * tile_size);
+    tile.format = TextureFormat::Rgba8;
+    tile.pixels.assign(static_cast<size_t>(tile.width) * tile.height * 4, 0);
+
+    int half   = tile_size / 2;
+    int last_x = std::min(2 * x + 1, source.TilesX(level - 1) - 1);
+    int last_y = std::min(2 * y + 1, source.TilesY(level - 1) - 1);
+    for (int child_y = 2 * y; child_y <= last_y; ++child_y)
+    {
+        for (int child_x = 2 * x; child_x <= last_x; ++child_x)
+        {
+            DecodedImage child;
+            if (!source.ReadTile(level - 1, child_x, child_y, child) ||
+                child.format != TextureFormat::Rgba8)
+            {
+                return false;
+            }
+
+            // the quarter of the tile that this child covers
+            int x0 = (child_x - 2 * x) * half;
+            int y0 = (child_y - 2 * y) * half;
+            int x1 = std::min(tile.width, x0 + (child.width + 1) / 2);
+            int y1 = std::min(tile.height, y0 + (child.height + 1) / 2);
+
+            for (int oy = y0; oy < y1; ++oy)
+            {
+                int sy0 = 2 * (oy - y0);
+                int sy1 = std::min(sy0 + 1, child.height - 1);
+                for (int ox = x0; ox < x1; ++ox)
+                {
+                    int sx0 = 2 * (ox - x0);
+                    int sx1 = std::min(sx0 + 1, child.width - 1);
+
+                    const uint8_t* p00 = Texel(child, sx0, sy0);
+                    const uint8_t* p01 = Texel(child, sx1, sy0);
+                    const uint8_t* p10 = Texel(child, sx0, sy1);
+                    const uint8_t* p11 = Texel(child, sx1, sy1);
+
+                    uint8_t* dst = Texel(tile, ox, oy);
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        dst[c] = static_cast<uint8_t>((p00[c] + p01[c] + p10[c] + p11[c] + 2) / 4);
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+TiledImageView::TiledImageView(std::shared_ptr<TileSource> source, TiledImageViewConfig config)
+    : source_(std::move(source)), config_(std::move(config)), loader_(config_.loader)
+{
+}
+
+bool TiledImageView::Draw(const char* str_id, ImVec2 size)
+{
+    loader_.Update();
+
+    ImVec2 available = ImGui::GetContentRegionAvail();
+    if (size.x <= 0.f)
+    {
+        size.x = std::max(available.x, 1.f);
+    }
+    if (size.y <= 0.f)
+    {
+        size.y = std::max(available.y, 1.f);
+    }
+
+    double width  = source_->Width();
+    double height = source_->Height();
+    double fit    = std::min(size.x / width, size.y / height);
+    if (fit_pending_)
+    {
+        zoom_        = fit;
+        view_x_      = (width - size.x / zoom_) / 2.;
+        view_y_      = (height - size.y / zoom_) / 2.;
+        fit_pending_ = false;
+    }
+
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImGui::InvisibleButton(str_id, size);
+
+    ImGuiIO& io = ImGui::GetIO();
+    if (ImGui::IsItemActive() && ImGui::IsMouseDragging(ImGuiMouseButton_Left, 0.f))
+    {
+        view_x_ -= io.MouseDelta.x / zoom_;
+        view_y_ -= io.MouseDelta.y / zoom_;
+    }
+    if (ImGui::IsItemHovered() && io.MouseWheel != 0.f)
+    {
+        // keep the pixel under the cursor in place
+        double mouse_x = view_x_ + (io.MousePos.x - origin.x) / zoom_;
+        double mouse_y = view_y_ + (io.MousePos.y - origin.y) / zoom_;
+
+        zoom_   = std::clamp(zoom_ * std::pow(1.25, io.MouseWheel), fit / 2., 32.);
+        view_x_ = mouse_x - (io.MousePos.x - origin.x) / zoom_;
+        view_y_ = mouse_y - (io.MousePos.y - origin.y) / zoom_;
+    }
+
+    // the finest level that still has at least one texel per screen pixel
+    int level_count = source_->LevelCount();
+    int level       = static_cast<int>(std::floor(std::log2(1. / zoom_)));
+    level           = std::clamp(level, 0, level_count - 1);
+
+    double span  = static_cast<double>(source_->TileSize()) * (1 << level);
+    int first_x  = std::max(0, static_cast<int>(std::floor(view_x_ / span)));
+    int first_y  = std::max(0, static_cast<int>(std::floor(view_y_ / span)));
+    int last_x   = std::min(source_->TilesX(level) - 1,
+                            static_cast<int>(std::floor((view_x_ + size.x / zoom_) / span)));
+    int last_y   = std::min(source_->TilesY(level) - 1,
+                            static_cast<int>(std::floor((view_y_ + size.y / zoom_) / span)));
+    bool pending = false;
+
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    draw_list->PushClipRect(origin, {origin.x + size.x, origin.y + size.y}, true);
+    for (int y = first_y; y <= last_y; ++y)
+    {
+        for (int x = first_x; x <= last_x; ++x)
+        {
+            Tile& tile = UseTile(level, x, y);
+            pending |= tile.request->GetState() == TextureRequest::State::Pending;
+
+            DrawTile(draw_list, origin, level, x, y);
+        }
+    }
+    draw_list->PopClipRect();
+
+    // requested last, so that it is decoded first, as the fallback for everything else
+    const Tile& top = UseTile(level_count - 1, 0, 0);
+    pending |= top.request->GetState() == TextureRequest::State::Pending;
+
+    Trim();
+    return pending || loader_.PendingCount() > 0;
+}
+
+TiledImageView::Tile& TiledImageView::UseTile(int level, int x, int y)
+{
+    Tile& tile = tiles_[TileKey(level, x, y)];
+    if (tile.request == nullptr)
+    {
+        std::weak_ptr<TileSource> source = source_;
+        tile.request = loader_.Load("tile", [source, level, x, y](DecodedImage& image) {
+            auto locked = source.lock();
+            return locked != nullptr && locked->ReadTile(level, x, y, image);
+        });
+    }
+
+    tile.last_used_frame = ImGui::GetFrameCount();
+    return tile;
+}
+
+PlatformTexture* TiledImageView::ReadyTile(int level, int x, int y)
+{
+    auto it = tiles_.find(TileKey(level, x, y));
+    if (it == tiles_.end() || it->second.request->Texture() == nullptr)
+    {
+        return nullptr;
+    }
+
+    it->second.last_used_frame = ImGui::GetFrameCount();
+    return it->second.request->Texture();
+}
+
+void TiledImageView::DrawTile(ImDrawList* draw_list, ImVec2 origin, int level, int x, int y)
+{
+    // the tile's rectangle in level 0 pixels
+    double tile_size    = source_->TileSize();
+    double scale        = static_cast<double>(1 << level);
+    double level_width  = source_->LevelWidth(level);
+    double level_height = source_->LevelHeight(level);
+
+    double x0 = x * tile_size * scale;
+    double y0 = y * tile_size * scale;
+    double x1 = std::min((x + 1) * tile_size, level_width) * scale;
+    double y1 = std::min((y + 1) * tile_size, level_height) * scale;
+
+    ImVec2 p0 = {origin.x + static_cast<float>((x0 - view_x_) * zoom_),
+                 origin.y + static_cast<float>((y0 - view_y_) * zoom_)};
+    ImVec2 p1 = {origin.x + static_cast<float>((x1 - view_x_) * zoom_),
+                 origin.y + static_cast<float>((y1 - view_y_) * zoom_)};
+
+    // this level or the closest coarser one that is loaded
+    for (int ancestor = level; ancestor < source_->LevelCount(); ++ancestor)
+    {
+        int shift                = ancestor - level;
+        int ancestor_x           = x >> shift;
+        int ancestor_y           = y >> shift;
+        PlatformTexture* texture = ReadyTile(ancestor, ancestor_x, ancestor_y);
+        if (texture == nullptr)
+        {
+            continue;
+        }
+
+        // where the rectangle lies within the ancestor tile
+        double ancestor_scale = static_cast<double>(1 << ancestor);
+        double tile_x         = ancestor_x * tile_size;
+        double tile_y         = ancestor_y * tile_size;
+        ImVec2 uv0 = {static_cast<float>((x0 / ancestor_scale - tile_x) / texture->Width()),
+                      static_cast<float>((y0 / ancestor_scale - tile_y) / texture->Height())};
+        ImVec2 uv1 = {static_cast<float>((x1 / ancestor_scale - tile_x) / texture->Width()),
+                      static_cast<float>((y1 / ancestor_scale - tile_y) / texture->Height())};
+
+        draw_list->AddImage(texture->Id(), p0, p1, uv0, uv1);
+        return;
+    }
+}
+
+void TiledImageView::Trim()
+{
+    int frame = ImGui::GetFrameCount();
+
+    // tiles that scrolled out of view before they were loaded are cancelled right away, their
+    // textures were never drawn
+    std::vector<std::pair<int, uint64_t>> ready;
+    for (auto it = tiles_.begin(); it != tiles_.end();)
+    {
+        const Tile& tile = it->second;
+        if (tile.last_used_frame < frame &&
+            tile.request->GetState() != TextureRequest::State::Ready)
+        {
+            it = tiles_.erase(it);
+            continue;
+        }
+
+        // NOTE tiles of the previous frame stay, the pipelined renderer may still be drawing them
+        if (tile.last_used_frame < frame - 1)
+        {
+            ready.emplace_back(tile.last_used_frame, it->first);
+        }
+        ++it;
+    }
+
+    int excess = static_cast<int>(tiles_.size()) - config_.max_cached_tiles;
+    if (excess <= 0)
+    {
+        return;
+    }
+
+    // least recently drawn first
+    std::sort(ready.begin(), ready.end());
+    for (int i = 0; i < excess && i < static_cast<int>(ready.size()); ++i)
+    {
+        tiles_.erase(ready[i].second);
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// a minimal fork-join pool, the calling thread takes part in every job
+class WorkerPool
+{
+private:
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    uint64_t generation_ = 0;
+    size_t busy_         = 0;
+    bool stop_           = false;
+
+    const std::function<void(int)>* job_ = nullptr;
+    int job_count_                       = 0;
+    std::atomic<int> next_{0};
+
+public:
+    explicit WorkerPool(int num_threads)
+    {
+        for (int i = 0; i < num_threads; ++i)
+        {
+            threads_.emplace_back([this] { Run(); });
+        }
+    }
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+
+        for (auto& thread : threads_)
+        {
+            thread.join();
+        }
+    }
+
+    // call fn(i) for every i in [0, count) and wait for completion
+    void ParallelFor(int count, const std::function<void(int)>& fn)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_       = &fn;
+            job_count_ = count;
+            next_      = 0;
+            busy_      = threads_.size();
+            generation_ += 1;
+        }
+        wake_.notify_all();
+
+        Drain();
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return busy_ == 0; });
+        job_ = nullptr;
+    }
+
+private:
+    void Drain()
+    {
+        for (int i = next_.fetch_add(1); i < job_count_; i = next_.fetch_add(1))
+        {
+            (*job_)(i);
+        }
+    }
+
+    void Run()
+    {
+        uint64_t seen = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_)
+                {
+                    return;
+                }
+                seen = generation_;
+            }
+
+            Drain();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                busy_ -= 1;
+            }
+            done_.notify_all();
+        }
+    }
+};